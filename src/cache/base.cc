@@ -16,6 +16,7 @@
 #include "cache/base.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 #include "portage/conf/portagesettings.h"
 #include "portage/package.h"
 #include "portage/packagetree.h"
@@ -55,6 +56,17 @@ string BasicCache::getPrefixedPath() const {
 	return m_scheme;
 }
 
+void BasicCache::getEclassDirs(WordVec *dirs) const {
+	string main(getPrefixedPath());
+	dirs->push_back(main + "/eclass");
+	const RepoList& repos(portagesettings->repos);
+	for(RepoList::const_iterator it(repos.begin()); likely(it != repos.end()); ++it) {
+		if(likely(it->path != main)) {
+			dirs->push_back(it->path + "/eclass");
+		}
+	}
+}
+
 string BasicCache::getPathHumanReadable() const {
 	string ret(m_scheme);
 	if(have_prefix) {
@@ -15,6 +15,7 @@
 #include <string>
 
 #include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
 #include "eixTk/sysutils.h"
 #include "eixTk/unused.h"
 #include "portage/extendedversion.h"
@@ -81,6 +82,9 @@ class BasicCache {
 		// Get scheme with path(s) for this cache
 		std::string getPathHumanReadable() const;
 
+		/// Get the eclass directories in the order of search: The own one first
+		void getEclassDirs(WordVec *dirs) const ATTRIBUTE_NONNULL_;
+
 		/// Set callback function to be used in case of errors
 		virtual void setErrorCallback(ErrorCallback error_callback) {
 			m_error_callback = error_callback;
@@ -94,6 +98,26 @@ class BasicCache {
 			return false;
 		}
 
+		/// Does the result not depend on the packages of previous overlays?
+		// Only then eix-update --jobs may read the overlay in a separate process.
+		virtual bool can_read_in_parallel() const ATTRIBUTE_CONST_VIRTUAL {
+			return false;
+		}
+
+		/// Is reading so expensive that eix-update --jobs should distribute
+		/// the categories to several processes (after reading previous overlays)?
+		virtual bool can_split_categories() const ATTRIBUTE_CONST_VIRTUAL {
+			return false;
+		}
+
+		/** Calculate a fingerprint of the files of the category prepared by
+		    readCategoryPrepare(). If it is unchanged, so is the result.
+		    @return false if the cache cannot provide fingerprints */
+		virtual bool fingerprint(std::string *fp ATTRIBUTE_UNUSED) const {
+			UNUSED(fp);
+			return false;
+		}
+
 		/** If available, the function to read multiple categories.
 		    @param packagetree should point to packagetree. The other parameters are only used if packagetree is NULLPTR:
 		    @param cat_name If packagetree is NULLPTR, only packages with this category name are read.
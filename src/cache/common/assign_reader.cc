@@ -9,14 +9,20 @@
 
 #include <config.h>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
 #include <cerrno>
 #include <cstring>
 
-#include <fstream>
+#include <algorithm>
 #include <string>
 
 #include "cache/base.h"
 #include "cache/common/assign_reader.h"
+#include "eixTk/diagnostics.h"
 #include "eixTk/formated.h"
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
@@ -26,82 +32,112 @@
 
 using std::string;
 
-using std::ifstream;
-
-static WordMap *get_map_from_cache(const char *file) ATTRIBUTE_NONNULL_;
-
-static WordMap *get_map_from_cache(const char *file) {
-	static string *oldfile = NULLPTR;
-	static WordMap *cf;
-	if(unlikely(oldfile == NULLPTR)) {
-		oldfile = new string(file);
-		cf = new WordMap;
-	} else {
-		if(*oldfile == file) {
-			return cf;
+bool AssignReader::read(const char *filename) {
+	if(m_file == filename) {
+		return true;
+	}
+	m_file.clear();
+	int fd(open(filename, O_RDONLY));
+	if(unlikely(fd < 0)) {
+		return false;
+	}
+	struct stat st;
+	if(unlikely(fstat(fd, &st) != 0)) {
+		int err(errno);
+		close(fd);
+		errno = err;
+		return false;
+	}
+	// The capacity of the buffer is kept, so usually nothing is allocated
+GCC_DIAG_OFF(sign-conversion)
+	string::size_type size(st.st_size);
+GCC_DIAG_ON(sign-conversion)
+	m_buffer.resize(size + 1);
+	string::size_type got(0);
+	while(got < size) {
+		ssize_t r(::read(fd, &(m_buffer[got]), size - got));
+		if(r <= 0) {
+			if(unlikely(r < 0) && (errno == EINTR)) {
+				continue;
+			}
+			break;
 		}
-		oldfile->assign(file);
-		cf->clear();
+GCC_DIAG_OFF(sign-conversion)
+		got += r;
+GCC_DIAG_ON(sign-conversion)
 	}
-
-	ifstream is(file);
-	if(unlikely(!is.is_open())) {
-		return NULLPTR;
+	int err(errno);
+	close(fd);
+	if(unlikely(got != size)) {
+		errno = err;
+		return false;
 	}
+	m_buffer[size] = '\0';
+	// Terminate each line so that the values can be handed out directly
+	std::replace(m_buffer.begin(), m_buffer.end(), '\n', '\0');
+	m_file.assign(filename);
+	return true;
+}
 
-	while(likely(is.good())) {
-		string lbuf;
-		getline(is, lbuf);
-		string::size_type p(lbuf.find('='));
-		if(p == string::npos) {
-			continue;
+const char *AssignReader::find(const char *key) const {
+	string::size_type len(std::strlen(key));
+	const char *end(m_buffer.c_str() + m_buffer.size());
+	for(const char *line(m_buffer.c_str()); likely(line < end);
+		line += std::strlen(line) + 1) {
+		if((std::strncmp(line, key, len) == 0) && (line[len] == '=')) {
+			return line + len + 1;
 		}
-		(*cf)[lbuf.substr(0, p)].assign(lbuf, p + 1, string::npos);
 	}
-	is.close();
-	return cf;
+	return NULLPTR;
 }
 
-const char *assign_get_md5sum(const string& filename) {
-	WordMap *cf(get_map_from_cache(filename.c_str()));
-	if(unlikely(cf == NULLPTR)) {
-		return NULLPTR;
+void AssignReader::assign(string *s, const char *key) const {
+	const char *value(find(key));
+	if(value != NULLPTR) {
+		s->assign(value);
+	} else {
+		s->clear();
 	}
-	WordMap::const_iterator md5(cf->find("_md5_"));
-	if(md5 == cf->end()) {
+}
+
+const char *AssignReader::get_value(const string& filename, const char *key) {
+	if(unlikely(!read(filename.c_str()))) {
 		return NULLPTR;
 	}
-	return md5->second.c_str();
+	return find(key);
 }
 
 /** Read stability and other data from an "assign type" cache file. */
-void assign_get_keywords_slot_iuse_restrict(const string& filename, string *keywords, string *slotname, string *iuse, string *restr, string *props,
+void AssignReader::get_keywords_slot_iuse_restrict(const string& filename, string *keywords, string *slotname, string *iuse, string *restr, string *props,
 	Depend *dep, BasicCache::ErrorCallback error_callback) {
-	WordMap *cf(get_map_from_cache(filename.c_str()));
-	if(unlikely(cf == NULLPTR)) {
+	if(unlikely(!read(filename.c_str()))) {
 		error_callback(eix::format(_("cannot read cache file %s: %s"))
-			% filename % strerror(errno));
+			% filename % std::strerror(errno));
 		return;
 	}
-	(*keywords) = (*cf)["KEYWORDS"];
-	(*slotname) = (*cf)["SLOT"];
-	(*iuse)     = (*cf)["IUSE"];
-	(*restr)    = (*cf)["RESTRICT"];
-	(*props)    = (*cf)["PROPERTIES"];
+	assign(keywords, "KEYWORDS");
+	assign(slotname, "SLOT");
+	assign(iuse,     "IUSE");
+	assign(restr,    "RESTRICT");
+	assign(props,    "PROPERTIES");
 	if(Depend::use_depend) {
-		dep->set((*cf)["DEPEND"], (*cf)["RDEPEND"], (*cf)["PDEPEND"], (*cf)["HDEPEND"], false);
+		string depend, rdepend, pdepend, hdepend;
+		assign(&depend,  "DEPEND");
+		assign(&rdepend, "RDEPEND");
+		assign(&pdepend, "PDEPEND");
+		assign(&hdepend, "HDEPEND");
+		dep->set(depend, rdepend, pdepend, hdepend, false);
 	}
 }
 
 /** Read an "assign type" cache file. */
-void assign_read_file(const char *filename, Package *pkg, BasicCache::ErrorCallback error_callback) {
-	WordMap *cf(get_map_from_cache(filename));
-	if(unlikely(cf == NULLPTR)) {
+void AssignReader::read_file(const char *filename, Package *pkg, BasicCache::ErrorCallback error_callback) {
+	if(unlikely(!read(filename))) {
 		error_callback(eix::format(_("cannot read cache file %s: %s"))
-			% filename % strerror(errno));
+			% filename % std::strerror(errno));
 		return;
 	}
-	pkg->homepage = (*cf)["HOMEPAGE"];
-	pkg->licenses = (*cf)["LICENSE"];
-	pkg->desc     = (*cf)["DESCRIPTION"];
+	assign(&(pkg->homepage), "HOMEPAGE");
+	assign(&(pkg->licenses), "LICENSE");
+	assign(&(pkg->desc),     "DESCRIPTION");
 }
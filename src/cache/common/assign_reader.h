@@ -17,8 +17,39 @@
 class Package;
 class Depend;
 
-const char *assign_get_md5sum(const std::string& filename);
-void assign_get_keywords_slot_iuse_restrict(const std::string& filename, std::string *keywords, std::string *slotname, std::string *iuse, std::string *restr, std::string *props, Depend *dep, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
-void assign_read_file(const char *filename, Package *pkg, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
+/**
+Read "assign" type cache files (like metadata/md5-cache).
+The last file is read at once into a buffer in which the lines are
+terminated by '\0', so values are found by scanning the buffer and are
+handed out without copying. Since each instance has its own buffer,
+several readers can be used independently.
+**/
+class AssignReader {
+	public:
+		/**
+		@return the value of key in filename or NULLPTR if there is none
+		or if the file cannot be read (errno is then set).
+		The pointer is valid until another file is read.
+		**/
+		const char *get_value(const std::string& filename, const char *key) ATTRIBUTE_NONNULL_;
+
+		const char *get_md5sum(const std::string& filename) {
+			return get_value(filename, "_md5_");
+		}
+
+		void get_keywords_slot_iuse_restrict(const std::string& filename, std::string *keywords, std::string *slotname, std::string *iuse, std::string *restr, std::string *props, Depend *dep, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
+		void read_file(const char *filename, Package *pkg, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
+
+	private:
+		std::string m_file, m_buffer;
+
+		/// Read filename into m_buffer unless it is the current file
+		bool read(const char *filename) ATTRIBUTE_NONNULL_;
+
+		const char *find(const char *key) const ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+
+		/// Assign the value of key or the empty string to *s
+		void assign(std::string *s, const char *key) const ATTRIBUTE_NONNULL_;
+};
 
 #endif  // SRC_CACHE_COMMON_ASSIGN_READER_H_
@@ -0,0 +1,172 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fstream>
+#include <string>
+
+#include "cache/base.h"
+#include "cache/common/assign_reader.h"
+#include "cache/common/ebuild_results.h"
+#include "eixTk/constexpr.h"
+#include "eixTk/formated.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "eixrc/eixrc.h"
+#include "eixrc/global.h"
+
+using std::ifstream;
+using std::ofstream;
+using std::string;
+
+/// The keys of the lines of a flat cache file as written by "ebuild depend"
+static const char *const flat_keys[] = {
+	"DEPEND", "RDEPEND", "SLOT", "SRC_URI", "RESTRICT", "HOMEPAGE",
+	"LICENSE", "DESCRIPTION", "KEYWORDS", "INHERITED", "IUSE",
+	"REQUIRED_USE", "PDEPEND", "PROVIDE", "EAPI", "PROPERTIES",
+	"DEFINED_PHASES", "HDEPEND"
+};
+static CONSTEXPR WordVec::size_type flat_size = sizeof(flat_keys) / sizeof(flat_keys[0]);
+static CONSTEXPR WordVec::size_type flat_inherited = 9;
+
+static bool make_parent_dirs(const string& file);
+
+/// Create all missing directories for file
+static bool make_parent_dirs(const string& file) {
+	for(string::size_type pos(file.find('/', 1)); likely(pos != string::npos);
+		pos = file.find('/', pos + 1)) {
+		string dir(file, 0, pos);
+		if((mkdir(dir.c_str(), 0755) != 0) && (errno != EEXIST)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+EbuildResults::EbuildResults(const BasicCache *b) : base(b) {
+	m_dir = get_eixrc()["EBUILD_RESULTS_DIR"];
+	while((!m_dir.empty()) && (*(m_dir.rbegin()) == '/')) {
+		m_dir.erase(m_dir.size() - 1);
+	}
+}
+
+bool EbuildResults::ebuild_stamp(string *stamp, const char *ebuild) {
+	struct stat st;
+	if(unlikely(stat(ebuild, &st) != 0)) {
+		return false;
+	}
+	*stamp = eix::format("%s %s") % st.st_mtime % st.st_size;
+	return true;
+}
+
+/// Describe the inherited eclasses by their names and mtimes
+bool EbuildResults::eclasses_stamp(string *stamp, const string& inherited, const WordVec& dirs) {
+	WordVec names;
+	split_string(&names, inherited, true);
+	stamp->clear();
+	for(WordVec::const_iterator it(names.begin()); likely(it != names.end()); ++it) {
+		WordVec::const_iterator d(dirs.begin());
+		struct stat st;
+		for(; likely(d != dirs.end()); ++d) {
+			if(stat((*d + "/" + *it + ".eclass").c_str(), &st) == 0) {
+				break;
+			}
+		}
+		if(unlikely(d == dirs.end())) {
+			return false;
+		}
+		if(!stamp->empty()) {
+			stamp->append(1, ' ');
+		}
+		stamp->append(eix::format("%s %s") % (*it) % st.st_mtime);
+	}
+	return true;
+}
+
+bool EbuildResults::lookup(string *file, const char *ebuild) const {
+	if(!enabled()) {
+		return false;
+	}
+	file->assign(m_dir);
+	file->append(ebuild);
+	string stamp;
+	const char *s(m_reader.get_value(*file, "_ebuild_"));
+	if((s == NULLPTR) || !ebuild_stamp(&stamp, ebuild) || (stamp != s)) {
+		return false;
+	}
+	s = m_reader.get_value(*file, "_eclasses_");
+	const char *inherited(m_reader.get_value(*file, "INHERITED"));
+	if((s == NULLPTR) || (inherited == NULLPTR)) {
+		return false;
+	}
+	WordVec dirs;
+	base->getEclassDirs(&dirs);
+	return (eclasses_stamp(&stamp, inherited, dirs) && (stamp == s));
+}
+
+void EbuildResults::store(const char *ebuild, const string& cachefile) const {
+	if(!enabled()) {
+		return;
+	}
+	WordVec lines;
+	{
+		ifstream is(cachefile.c_str());
+		if(unlikely(!is.is_open())) {
+			return;
+		}
+		string line;
+		while(getline(is, line)) {
+			lines.push_back(line);
+		}
+	}
+	if(unlikely(lines.size() <= flat_inherited)) {
+		return;
+	}
+	string ebuild_st, eclasses_st;
+	WordVec dirs;
+	base->getEclassDirs(&dirs);
+	if(unlikely(!ebuild_stamp(&ebuild_st, ebuild) ||
+		!eclasses_stamp(&eclasses_st, lines[flat_inherited], dirs))) {
+		return;
+	}
+	string file(m_dir);
+	file.append(ebuild);
+	if(unlikely(!make_parent_dirs(file))) {
+		return;
+	}
+	// Write into a temporary file to never leave a partial result
+	string temp(file + ".tmp");
+	{
+		ofstream os(temp.c_str());
+		if(unlikely(!os.is_open())) {
+			return;
+		}
+		for(WordVec::size_type i(0); likely((i < flat_size) && (i < lines.size())); ++i) {
+			os << flat_keys[i] << '=' << lines[i] << '\n';
+		}
+		os << "_ebuild_=" << ebuild_st << '\n';
+		os << "_eclasses_=" << eclasses_st << '\n';
+		os.close();
+		if(unlikely(os.fail())) {
+			unlink(temp.c_str());
+			return;
+		}
+	}
+	if(unlikely(rename(temp.c_str(), file.c_str()) != 0)) {
+		unlink(temp.c_str());
+	}
+}
@@ -0,0 +1,57 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_CACHE_COMMON_EBUILD_RESULTS_H_
+#define SRC_CACHE_COMMON_EBUILD_RESULTS_H_ 1
+
+#include <string>
+
+#include "cache/common/assign_reader.h"
+#include "eixTk/stringtypes.h"
+
+class BasicCache;
+
+/**
+Persistent storage for the results of executed ebuilds.
+For each ebuild, a file in "assign" format (like metadata/md5-cache)
+is stored below EBUILD_RESULTS_DIR under the full path of the ebuild.
+Besides the data, it contains mtime and size of the ebuild and the
+mtimes of all inherited eclasses; it is used only if all of these match.
+**/
+class EbuildResults {
+	private:
+		const BasicCache *base;
+		std::string m_dir;
+		/// Keeps the file of the last lookup; lookup() is const
+		mutable AssignReader m_reader;
+
+		static bool ebuild_stamp(std::string *stamp, const char *ebuild) ATTRIBUTE_NONNULL_;
+		static bool eclasses_stamp(std::string *stamp, const std::string& inherited, const WordVec& dirs) ATTRIBUTE_NONNULL_;
+
+	public:
+		explicit EbuildResults(const BasicCache *b) ATTRIBUTE_NONNULL_;
+
+		bool enabled() const {
+			return !m_dir.empty();
+		}
+
+		/**
+		@return true if there is a valid result for ebuild; its name
+		(an "assign" type cache file) is stored in file
+		**/
+		bool lookup(std::string *file, const char *ebuild) const ATTRIBUTE_NONNULL_;
+
+		/// The reader which has read the file of the last lookup()
+		AssignReader *reader() const {
+			return &m_reader;
+		}
+
+		/// Store the result of ebuild given as the flat cachefile
+		void store(const char *ebuild, const std::string& cachefile) const ATTRIBUTE_NONNULL_;
+};
+
+#endif  // SRC_CACHE_COMMON_EBUILD_RESULTS_H_
@@ -0,0 +1,261 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <sys/stat.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "cache/common/eclass_reader.h"
+#include "eixTk/formated.h"
+#include "eixTk/i18n.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/snapshot.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "eixTk/varsreader.h"
+
+using std::list;
+using std::string;
+using std::vector;
+
+/// Variables to which each eclass contributes, appended to the ebuild's value
+static const char *const accumulated_vars[] = {
+	"IUSE", "REQUIRED_USE", "DEPEND", "RDEPEND", "PDEPEND", "HDEPEND",
+	NULLPTR
+};
+
+/// Variables for which the last eclass provides a default for the ebuild
+static const char *const default_vars[] = {
+	"SLOT", "KEYWORDS", "HOMEPAGE", "LICENSE", "DESCRIPTION", "RESTRICT",
+	"PROPERTIES",
+	NULLPTR
+};
+
+EclassReader::EclassMap *EclassReader::shared = NULLPTR;
+
+static bool in_list(const char *const *names, const string& var) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static bool is_relevant(const string& var) ATTRIBUTE_PURE;
+static bool refers_to_vars(const WordMap& vars) ATTRIBUTE_PURE;
+
+static bool in_list(const char *const *names, const string& var) {
+	for(; likely(*names != NULLPTR); ++names) {
+		if(var == *names) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool is_relevant(const string& var) {
+	return (in_list(accumulated_vars, var) || in_list(default_vars, var));
+}
+
+/// @return true if some relevant value contains a reference to a variable
+static bool refers_to_vars(const WordMap& vars) {
+	for(WordMap::const_iterator it(vars.begin()); likely(it != vars.end()); ++it) {
+		if((it->second.find('$') != string::npos) && is_relevant(it->first)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void EclassReader::find_inherits(WordVec *names, const string& content) {
+	for(string::size_type line(0); line < content.size(); ) {
+		string::size_type eol(content.find('\n', line));
+		if(eol == string::npos) {
+			eol = content.size();
+		}
+		string::size_type pos(content.find_first_not_of(" \t", line));
+		line = eol + 1;
+		// "inherit" contains no newline, so a match lies within the line
+		if((pos >= eol) || (content.compare(pos, 7, "inherit") != 0)) {
+			continue;
+		}
+		pos += 7;
+		if((pos >= eol) || ((content[pos] != ' ') && (content[pos] != '\t'))) {
+			continue;
+		}
+		string::size_type end(content.find_first_of("#;&|\n", pos));
+		if(end > eol) {
+			end = eol;
+		}
+		WordVec args;
+		split_string(&args, content.substr(pos, end - pos));
+		for(WordVec::const_iterator it(args.begin()); likely(it != args.end()); ++it) {
+			// Names computed at runtime cannot be resolved here
+			if(likely(it->find_first_of("$`\"'\\") == string::npos)) {
+				names->push_back(*it);
+			}
+		}
+	}
+}
+
+const EclassReader::Eclass *EclassReader::get(const string& name, const WordVec& dirs, string *errtext) {
+	EclassMap::const_iterator found(eclasses.find(name));
+	if(found != eclasses.end()) {
+		return found->second;
+	}
+	string file;
+	struct stat st;
+	WordVec::const_iterator it(dirs.begin());
+	for(; likely(it != dirs.end()); ++it) {
+		file = (*it) + "/" + name + ".eclass";
+		if((stat(file.c_str(), &st) == 0) && S_ISREG(st.st_mode)) {
+			break;
+		}
+	}
+	if(unlikely(it == dirs.end())) {
+		*errtext = eix::format(_("cannot find eclass %s")) % name;
+		return NULLPTR;
+	}
+	if(shared == NULLPTR) {
+		shared = new EclassMap;
+	}
+	string key(m_subst ? "+" : "-");
+	key.append(file);
+	found = shared->find(key);
+	if((found != shared->end()) && (found->second->mtime == st.st_mtime)) {
+		eclasses[name] = found->second;
+		return found->second;
+	}
+	string content;
+	if(unlikely(!snapshot_read(file.c_str(), &content))) {
+		*errtext = eix::format(_("cannot read file %r")) % file;
+		return NULLPTR;
+	}
+	Eclass *eclass(new Eclass);
+	eclass->mtime = st.st_mtime;
+	// Without knowledge of the ebuild, variables cannot be substituted yet
+	VarsReader reader(VarsReader::INTO_MAP);
+	reader.useMap(&(eclass->vars));
+	if(unlikely(!reader.readmem(content.c_str(), content.c_str() + content.size(), errtext))) {
+		delete eclass;
+		return NULLPTR;
+	}
+	find_inherits(&(eclass->inherits), content);
+	eclass->refers = refers_to_vars(eclass->vars);
+	if(m_subst && eclass->refers) {
+		eclass->content.swap(content);
+	}
+	// A previous version of a changed file is not freed: Other instances may use it
+	(*shared)[key] = eclasses[name] = eclass;
+	return eclass;
+}
+
+/// Collect the eclasses in the order in which they are sourced
+bool EclassReader::collect(vector<const Eclass *> *order, WordSet *seen, const WordVec& inherits, const WordVec& dirs, string *errtext) {
+	for(WordVec::const_iterator it(inherits.begin()); likely(it != inherits.end()); ++it) {
+		if(!seen->insert(*it).second) {
+			continue;
+		}
+		const Eclass *eclass(get(*it, dirs, errtext));
+		if(unlikely(eclass == NULLPTR)) {
+			return false;
+		}
+		// The eclasses inherited by an eclass are sourced before its rest
+		if(unlikely(!collect(order, seen, eclass->inherits, dirs, errtext))) {
+			return false;
+		}
+		order->push_back(eclass);
+	}
+	return true;
+}
+
+bool EclassReader::apply(VarsReader *ebuild, const WordVec& inherits, const WordVec& dirs, string *errtext) {
+	vector<const Eclass *> order;
+	WordSet seen;
+	if(unlikely(!collect(&order, &seen, inherits, dirs, errtext))) {
+		return false;
+	}
+	// The relevant values of each eclass; those of eclasses referring
+	// to variables are evaluated with the variables of the ebuild
+	vector<const WordMap *> values;
+	list<WordMap> evaluated;
+	WordMap seed;
+	bool have_seed(false);
+	for(vector<const Eclass *>::const_iterator it(order.begin()); likely(it != order.end()); ++it) {
+		if(likely(!(*it)->refers)) {
+			values.push_back(&((*it)->vars));
+			continue;
+		}
+		if(!m_subst) {
+			if(m_strict) {
+				*errtext = _("eclass refers to variables");
+				return false;
+			}
+			values.push_back(&((*it)->vars));
+			continue;
+		}
+		if(!have_seed) {
+			have_seed = true;
+			// The relevant variables of the ebuild are merged later
+			for(VarsReader::const_iterator v(ebuild->begin()); likely(v != ebuild->end()); ++v) {
+				if(!is_relevant(v->first)) {
+					seed.insert(seed.end(), *v);
+				}
+			}
+		}
+		WordMap vars(seed);
+		VarsReader reader(VarsReader::INTO_MAP | VarsReader::SUBST_VARS);
+		reader.useMap(&vars);
+		const string& content((*it)->content);
+		if(unlikely(!reader.readmem(content.c_str(), content.c_str() + content.size(), errtext))) {
+			return false;
+		}
+		evaluated.push_back(WordMap());
+		WordMap& result(evaluated.back());
+		for(WordMap::const_iterator v((*it)->vars.begin()); likely(v != (*it)->vars.end()); ++v) {
+			if(is_relevant(v->first)) {
+				result[v->first] = vars[v->first];
+			}
+		}
+		values.push_back(&result);
+	}
+	for(const char *const *var(accumulated_vars); likely(*var != NULLPTR); ++var) {
+		string value;
+		const string *s(ebuild->find(*var));
+		if(s != NULLPTR) {
+			value = *s;
+		}
+		bool found(s != NULLPTR);
+		for(vector<const WordMap *>::const_iterator it(values.begin()); likely(it != values.end()); ++it) {
+			WordMap::const_iterator v((*it)->find(*var));
+			if(v == (*it)->end()) {
+				continue;
+			}
+			found = true;
+			if(!v->second.empty()) {
+				if(!value.empty()) {
+					value.append(1, ' ');
+				}
+				value.append(v->second);
+			}
+		}
+		if(found) {
+			(*ebuild)[*var] = value;
+		}
+	}
+	for(const char *const *var(default_vars); likely(*var != NULLPTR); ++var) {
+		if(ebuild->find(*var) != NULLPTR) {
+			continue;
+		}
+		for(vector<const WordMap *>::const_reverse_iterator it(values.rbegin()); likely(it != values.rend()); ++it) {
+			WordMap::const_iterator v((*it)->find(*var));
+			if(v != (*it)->end()) {
+				(*ebuild)[*var] = v->second;
+				break;
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,75 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_CACHE_COMMON_ECLASS_READER_H_
+#define SRC_CACHE_COMMON_ECLASS_READER_H_ 1
+
+#include <ctime>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eixTk/stringtypes.h"
+
+class VarsReader;
+
+/**
+Resolve "inherit" of ebuilds without executing them: The variable
+assignments of the eclasses are read with VarsReader and merged into the
+variables of the ebuild like portage does for the common cases.
+The parsed eclasses are kept in memory and shared by all instances, so
+each eclass file is parsed only once per run. Only if a relevant value
+refers to other variables (like ${PN}), the eclass is evaluated again
+for each ebuild with the variables of that ebuild.
+**/
+class EclassReader {
+	public:
+		/// The data of a parsed eclass
+		class Eclass {
+			public:
+				WordMap vars;  ///< the values without substitution
+				WordVec inherits;
+				time_t mtime;
+				/// Some relevant value refers to other variables
+				bool refers;
+				/// The file content if it must be evaluated for each ebuild
+				std::string content;
+		};
+
+		/**
+		@param subst substitute variables like in the ebuild
+		@param strict fail for unsubstituted references to variables
+		(so that the ebuild can be executed instead)
+		**/
+		EclassReader(bool subst, bool strict) : m_subst(subst), m_strict(strict) {
+		}
+
+		/**
+		Add the variables of the eclasses (and those inherited by them)
+		to ebuild which was read without them.
+		@param dirs the eclass directories in the order of search
+		@return false if some eclass cannot be read
+		**/
+		bool apply(VarsReader *ebuild, const WordVec& inherits, const WordVec& dirs, std::string *errtext) ATTRIBUTE_NONNULL_;
+
+		/// Append the arguments of all "inherit" commands in content to names
+		static void find_inherits(WordVec *names, const std::string& content) ATTRIBUTE_NONNULL_;
+
+	private:
+		typedef std::map<std::string, const Eclass *> EclassMap;
+		/// The eclasses found for our names
+		EclassMap eclasses;
+		/// The eclasses of all instances, indexed by mode and file
+		static EclassMap *shared;
+		bool m_subst, m_strict;
+
+		const Eclass *get(const std::string& name, const WordVec& dirs, std::string *errtext) ATTRIBUTE_NONNULL_;
+		bool collect(std::vector<const Eclass *> *order, WordSet *seen, const WordVec& inherits, const WordVec& dirs, std::string *errtext) ATTRIBUTE_NONNULL_;
+};
+
+#endif  // SRC_CACHE_COMMON_ECLASS_READER_H_
@@ -0,0 +1,164 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "cache/common/md5_sums.h"
+#include "eixTk/diagnostics.h"
+#include "eixTk/formated.h"
+#include "eixTk/likely.h"
+#include "eixTk/md5.h"
+#include "eixTk/null.h"
+#include "eixTk/stringutils.h"
+#include "eixrc/eixrc.h"
+#include "eixrc/global.h"
+
+using std::ifstream;
+using std::istringstream;
+using std::ofstream;
+using std::string;
+
+/// Lines of other (older) formats are ignored
+#define MD5_SUMS_FORMAT "2"
+
+Md5Sums *Md5Sums::get() {
+	static bool initialized(false);
+	static Md5Sums *md5sums(NULLPTR);
+	if(!initialized) {
+		initialized = true;
+		const string& file(get_eixrc()["EBUILD_MD5_CACHE"]);
+		if(!file.empty()) {
+			md5sums = new Md5Sums(file);
+		}
+	}
+	return md5sums;
+}
+
+Md5Sums::Md5Sums(const string& file) : m_file(file) {
+	Entries::size_type lines(load());
+	// Entries of changed ebuilds are appended: Drop the old ones from time to time
+	if(lines > 2 * entries.size() + 1000) {
+		rewrite();
+	}
+}
+
+/**
+Each line has the form "MD5_SUMS_FORMAT md5sum inode mtime nsec size file";
+later lines override earlier ones for the same file.
+**/
+Md5Sums::Entries::size_type Md5Sums::load() {
+	ifstream is(m_file.c_str());
+	if(!is.is_open()) {
+		return 0;
+	}
+	Entries::size_type lines(0);
+	string line;
+	while(getline(is, line)) {
+		++lines;
+		istringstream ls(line);
+		Entry entry;
+		string format, file;
+		if(!(ls >> format) || (format != MD5_SUMS_FORMAT) ||
+			!(ls >> entry.md5sum >> entry.ino >> entry.mtime >> entry.nsec >> entry.size)) {
+			continue;
+		}
+		ls.get();
+		getline(ls, file);
+		if(likely((entry.md5sum.size() == 32) && !file.empty())) {
+			entries[file] = entry;
+		}
+	}
+	return lines;
+}
+
+void Md5Sums::rewrite() {
+	string tmpfile(m_file + ".tmp");
+	{
+		ofstream os(tmpfile.c_str());
+		if(unlikely(!os.is_open())) {
+			return;
+		}
+		for(Entries::const_iterator it(entries.begin()); likely(it != entries.end()); ++it) {
+			const Entry& entry(it->second);
+			os << MD5_SUMS_FORMAT << ' ' << entry.md5sum << ' ' << entry.ino << ' ' <<
+				entry.mtime << ' ' << entry.nsec << ' ' << entry.size << ' ' << it->first << '\n';
+		}
+		if(unlikely(!os.good())) {
+			os.close();
+			std::remove(tmpfile.c_str());
+			return;
+		}
+	}
+	if(unlikely(std::rename(tmpfile.c_str(), m_file.c_str()) != 0)) {
+		std::remove(tmpfile.c_str());
+	}
+}
+
+bool Md5Sums::verify(const string& file, const string& md5sum) {
+	struct stat st;
+	if(unlikely(stat(file.c_str(), &st) != 0)) {
+		return false;
+	}
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+	long nsec(st.st_mtim.tv_nsec);
+#else
+	long nsec(0);
+#endif
+	Entries::const_iterator it(entries.find(file));
+	if((it != entries.end()) && (it->second.ino == st.st_ino) &&
+		(it->second.mtime == st.st_mtime) && (it->second.nsec == nsec) &&
+		(it->second.size == st.st_size)) {
+		return caseequal(md5sum, it->second.md5sum.c_str());
+	}
+	Entry entry;
+	if(unlikely(!get_md5sum(file.c_str(), &(entry.md5sum)))) {
+		return false;
+	}
+	entry.ino = st.st_ino;
+	entry.mtime = st.st_mtime;
+	entry.nsec = nsec;
+	entry.size = st.st_size;
+	m_pending.append(eix::format(MD5_SUMS_FORMAT " %s %s %s %s %s %s\n") %
+		entry.md5sum % entry.ino % entry.mtime % entry.nsec % entry.size % file);
+	bool ok(caseequal(md5sum, entry.md5sum.c_str()));
+	entries[file] = entry;
+	return ok;
+}
+
+void Md5Sums::flush() {
+	if(m_pending.empty()) {
+		return;
+	}
+	// With O_APPEND, parallel processes do not overwrite each other's lines
+	int fd(open(m_file.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644));
+	if(likely(fd >= 0)) {
+		string::size_type done(0);
+		while(done < m_pending.size()) {
+			ssize_t r(write(fd, m_pending.c_str() + done, m_pending.size() - done));
+			if(r <= 0) {
+				break;
+			}
+GCC_DIAG_OFF(sign-conversion)
+			done += r;
+GCC_DIAG_ON(sign-conversion)
+		}
+		close(fd);
+	}
+	m_pending.clear();
+}
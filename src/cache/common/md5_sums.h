@@ -0,0 +1,57 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_CACHE_COMMON_MD5_SUMS_H_
+#define SRC_CACHE_COMMON_MD5_SUMS_H_ 1
+
+#include <sys/types.h>
+
+#include <ctime>
+
+#include <map>
+#include <string>
+
+/**
+Persistent storage of the md5sums of ebuilds which are verified against
+metadata/md5-cache. The file EBUILD_MD5_CACHE contains for each ebuild its
+md5sum together with inode, mtime (with nanoseconds if available), and
+size; the stored md5sum is used as
+long as these are unchanged. New sums are appended to the file, so that
+several processes of eix-update --jobs can add their entries.
+**/
+class Md5Sums {
+	public:
+		/// @return the storage shared in the process or NULLPTR if disabled
+		static Md5Sums *get();
+
+		/// Like verify_md5sum(), but calculate the md5sum only if necessary
+		bool verify(const std::string& file, const std::string& md5sum);
+
+		/// Append the new sums to the file
+		void flush();
+
+	private:
+		class Entry {
+			public:
+				ino_t ino;
+				time_t mtime;
+				long nsec;
+				off_t size;
+				std::string md5sum;
+		};
+		typedef std::map<std::string, Entry> Entries;
+		Entries entries;
+		std::string m_file, m_pending;
+
+		explicit Md5Sums(const std::string& file);
+
+		/// @return the number of lines of the file
+		Entries::size_type load();
+		void rewrite();
+};
+
+#endif  // SRC_CACHE_COMMON_MD5_SUMS_H_
@@ -0,0 +1,66 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "cache/common/prefetch.h"
+#include "eixTk/likely.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/unused.h"
+
+using std::string;
+
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#ifdef HAVE_OPENAT
+#ifndef O_DIRECTORY
+#define O_DIRECTORY 0
+#endif
+#endif
+
+void prefetch_files(const string& dir, const WordVec& names) {
+#ifdef HAVE_OPENAT
+	// Resolve the directory only once
+	int dirfd(open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+	if(unlikely(dirfd < 0)) {
+		return;
+	}
+#endif
+	for(WordVec::const_iterator it(names.begin()); likely(it != names.end()); ++it) {
+#ifdef HAVE_OPENAT
+		int fd(openat(dirfd, it->c_str(), O_RDONLY | O_CLOEXEC));
+#else
+		int fd(open((dir + "/" + (*it)).c_str(), O_RDONLY | O_CLOEXEC));
+#endif
+		if(unlikely(fd < 0)) {
+			continue;
+		}
+		posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+		close(fd);
+	}
+#ifdef HAVE_OPENAT
+	close(dirfd);
+#endif
+}
+
+#else
+
+void prefetch_files(const string& dir, const WordVec& names) {
+	UNUSED(dir);
+	UNUSED(names);
+}
+
+#endif
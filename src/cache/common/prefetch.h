@@ -0,0 +1,22 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_CACHE_COMMON_PREFETCH_H_
+#define SRC_CACHE_COMMON_PREFETCH_H_ 1
+
+#include <string>
+
+#include "eixTk/stringtypes.h"
+
+/**
+Tell the kernel that the files named in directory dir will be read soon.
+The reads are started asynchronously, so the latencies of the subsequent
+reads of the files overlap. This is only a hint and never fails.
+**/
+void prefetch_files(const std::string& dir, const WordVec& names);
+
+#endif  // SRC_CACHE_COMMON_PREFETCH_H_
@@ -15,6 +15,7 @@
 
 #include "cache/eixcache/eixcache.h"
 #include "database/header.h"
+#include "database/index.h"
 #include "database/io.h"
 #include "database/package_reader.h"
 #include "eixTk/formated.h"
@@ -25,9 +26,11 @@
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 #include "portage/basicversion.h"
+#include "portage/keywords.h"
 #include "portage/conf/portagesettings.h"
 #include "portage/package.h"
 #include "portage/packagetree.h"
+#include "portage/version.h"
 
 using std::string;
 
@@ -162,27 +165,41 @@ bool EixCache::get_destcat(PackageTree *packagetree, const char *cat_name, Categ
 	return false;
 }
 
-void EixCache::get_package(Package *p) {
+void EixCache::get_package(Package *p, bool steal) {
 	if(dest_cat == NULLPTR) {
 		return;
 	}
 	bool have_onetime_info(false), have_pkg(false);
 	Package *pkg(NULLPTR);
-	for(Package::iterator it(p->begin()); likely(it != p->end()); ++it) {
+	for(Package::iterator it(p->begin()); likely(it != p->end()); ) {
 		if(m_only_overlay) {
-			if(likely(it->overlay_key != m_get_overlay))
+			if(likely(it->overlay_key != m_get_overlay)) {
+				++it;
 				continue;
+			}
+		}
+		Version *version;
+		if(steal) {
+			version = *it;
+			it = p->erase(it);
+			// Forget what refers to the foreign database
+			version->maskflags.set(MaskFlags::MASK_NONE);
+			version->forget_saved_masks();
+			version->reponame.clear();
+			version->priority = 0;
+		} else {
+			version = new Version;
+			*static_cast<BasicVersion *>(version) = *static_cast<BasicVersion *>(*it);
+			version->set_full_keywords(it->get_full_keywords());
+			version->slotname = it->slotname;
+			version->subslotname = it->subslotname;
+			version->restrictFlags = it->restrictFlags;
+			version->propertiesFlags = it->propertiesFlags;
+			version->iuse = it->iuse;
+			version->depend = it->depend;
+			++it;
 		}
-		Version *version(new Version);
-		*static_cast<BasicVersion *>(version) = *static_cast<BasicVersion *>(*it);
 		version->overlay_key = m_overlay_key;
-		version->set_full_keywords(it->get_full_keywords());
-		version->slotname = it->slotname;
-		version->subslotname = it->subslotname;
-		version->restrictFlags = it->restrictFlags;
-		version->propertiesFlags = it->propertiesFlags;
-		version->iuse = it->iuse;
-		version->depend = it->depend;
 		if(pkg == NULLPTR) {
 			pkg = dest_cat->findPackage(p->name);
 			if(pkg != NULLPTR) {
@@ -256,33 +273,68 @@ bool EixCache::readCategories(PackageTree *packagetree, const char *cat_name, Ca
 		return false;
 	}
 
-	PackageReader reader(&db, header);
-	for(; reader.next(); reader.skip()) {
-		if(unlikely(!reader.read(PackageReader::NAME))) {
-			break;
-		}
-		Package *p(reader.get());
-
-		success = false;
+	// Only if no slave adds categories, we know which ones we need
+	bool need_all(false);
+	if(packagetree != NULLPTR) {
 		for(Slaves::const_iterator sl(slaves.begin());
 			unlikely(sl != slaves.end()); ++sl) {
-			if((*sl)->get_destcat(packagetree, cat_name, category, p->category)) {
-				success = true;
+			if(!(*sl)->never_add_categories) {
+				need_all = true;
+				break;
 			}
 		}
-		if(!success) {
+	}
+	DBIndex index;
+	if(need_all || !db.read_index(&index, header, NULLPTR)) {
+		PackageReader reader(&db, header);
+		return read_packages(&reader, slaves, packagetree, cat_name, category);
+	}
+	// Jump to the categories we need with the index
+	for(DBIndex::CategoryTable::const_iterator it(index.categories.begin());
+		likely(it != index.categories.end()); ++it) {
+		if((packagetree == NULLPTR) ? (it->name != cat_name) :
+			(packagetree->find(it->name) == NULLPTR)) {
 			continue;
 		}
-		if(unlikely(!reader.read())) {
-			break;
+		PackageReader reader(&db, header);
+		reader.useCategories(it->offset, 1);
+		if(unlikely(!read_packages(&reader, slaves, packagetree, cat_name, category))) {
+			return false;
 		}
-		p = reader.get();
-		for(Slaves::const_iterator sl(slaves.begin());
-			unlikely(sl != slaves.end()); ++sl) {
-			(*sl)->get_package(p);
+	}
+	return true;
+}
+
+bool EixCache::read_packages(PackageReader *reader, const Slaves& slaves, PackageTree *packagetree, const char *cat_name, Category *category) {
+	if(likely(reader->get_errtext() == NULLPTR)) {
+		for(; reader->next(); reader->skip()) {
+			if(unlikely(!reader->read(PackageReader::NAME))) {
+				break;
+			}
+			Package *p(reader->get());
+
+			bool success(false);
+			for(Slaves::const_iterator sl(slaves.begin());
+				unlikely(sl != slaves.end()); ++sl) {
+				if((*sl)->get_destcat(packagetree, cat_name, category, p->category)) {
+					success = true;
+				}
+			}
+			if(!success) {
+				continue;
+			}
+			if(unlikely(!reader->read())) {
+				break;
+			}
+			p = reader->get();
+			// The package is not needed afterwards: The last slave can take it
+			for(Slaves::const_iterator sl(slaves.begin());
+				unlikely(sl != slaves.end()); ++sl) {
+				(*sl)->get_package(p, (sl + 1 == slaves.end()));
+			}
 		}
 	}
-	const char *err_cstr(reader.get_errtext());
+	const char *err_cstr(reader->get_errtext());
 	if(unlikely(err_cstr != NULLPTR)) {
 		allerrors(slaves, eix::format(_("error in file %s: %s")) % m_full % err_cstr);
 		m_error_callback(err_msg);
@@ -18,6 +18,7 @@
 class Category;
 class DBHeader;
 class Package;
+class PackageReader;
 class PackageTree;
 
 class EixCache : public BasicCache {
@@ -37,7 +38,9 @@ class EixCache : public BasicCache {
 		void thiserror(const std::string& msg);
 		bool get_overlaydat(const DBHeader& header);
 		bool get_destcat(PackageTree *packagetree, const char *cat_name, Category *category, const std::string& pcat) ATTRIBUTE_NONNULL((3));
-		void get_package(Package *p) ATTRIBUTE_NONNULL_;
+		/// If steal, the versions are moved out of p instead of copied
+		void get_package(Package *p, bool steal) ATTRIBUTE_NONNULL_;
+		bool read_packages(PackageReader *reader, const Slaves& slaves, PackageTree *packagetree, const char *cat_name, Category *category) ATTRIBUTE_NONNULL((2));
 
 	public:
 		~EixCache();
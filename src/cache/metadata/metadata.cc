@@ -10,6 +10,7 @@
 #include <config.h>
 
 #include <dirent.h>
+#include <sys/stat.h>
 
 #include <cstdlib>
 #include <cstring>
@@ -18,7 +19,9 @@
 
 #include "cache/common/assign_reader.h"
 #include "cache/common/flat_reader.h"
+#include "cache/common/prefetch.h"
 #include "cache/metadata/metadata.h"
+#include "eixTk/eixint.h"
 #include "eixTk/formated.h"
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
@@ -40,6 +43,7 @@ using std::string;
 #define PORTAGE_CACHE_PATH	"var/cache/edb/dep"
 
 static int cachefiles_selector(SCANDIR_ARG3 dent);
+static void fingerprint_add(eix::UNumber *hash, const void *data, size_t len) ATTRIBUTE_NONNULL_;
 
 bool MetadataCache::use_prefixport() const {
 	switch(path_type) {
@@ -150,13 +154,7 @@ void MetadataCache::setType(PathType set_path_type, bool set_flat) {
 }
 
 void MetadataCache::setFlat(bool set_flat) {
-	if(set_flat) {
-		x_get_keywords_slot_iuse_restrict = flat_get_keywords_slot_iuse_restrict;
-		x_read_file = flat_read_file;
-	} else {
-		x_get_keywords_slot_iuse_restrict = assign_get_keywords_slot_iuse_restrict;
-		x_read_file = assign_read_file;
-	}
+	read_flat = set_flat;
 }
 
 static int cachefiles_selector(SCANDIR_ARG3 dent) {
@@ -269,7 +267,11 @@ void MetadataCache::get_version_info(const char *pkg_name, const char *ver_name,
 	path.append(pkg_name);
 	path.append(1, '-');
 	path.append(ver_name);
-	(*x_get_keywords_slot_iuse_restrict)(path, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
+	if(read_flat) {
+		flat_get_keywords_slot_iuse_restrict(path, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
+	} else {
+		assign_reader.get_keywords_slot_iuse_restrict(path, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
+	}
 	version->set_slotname(slot);
 	version->set_full_keywords(keywords);
 	version->set_iuse(iuse);
@@ -282,10 +284,51 @@ const char *MetadataCache::get_md5sum(const char *pkg_name, const char *ver_name
 	if(!checkmd5) {
 		return NULLPTR;
 	}
-	return assign_get_md5sum(m_catpath + "/" + pkg_name + "-" + ver_name);
+	return assign_reader.get_md5sum(m_catpath + "/" + pkg_name + "-" + ver_name);
+}
+
+void MetadataCache::get_common_info(const char *pkg_name, const char *ver_name, Package *pkg) const {
+	string path(m_catpath + "/" + pkg_name + "-" + ver_name);
+	if(read_flat) {
+		flat_read_file(path.c_str(), pkg, m_error_callback);
+	} else {
+		assign_reader.read_file(path.c_str(), pkg, m_error_callback);
+	}
+}
+
+/// FNV-1a hash of len bytes of data
+static void fingerprint_add(eix::UNumber *hash, const void *data, size_t len) {
+	const eix::UChar *p(static_cast<const eix::UChar *>(data));
+	for(; len != 0; --len) {
+		*hash = (*hash ^ *(p++)) * 16777619U;
+	}
+}
+
+/** Hash names, inodes, modification times, and sizes of all files of the
+    category; files rewritten within a second differ at least in the inode
+    or (if available) in the nanoseconds */
+bool MetadataCache::fingerprint(string *fp) const {
+	eix::UNumber hash(2166136261U);
+	for(WordVec::const_iterator it(names.begin()); likely(it != names.end()); ++it) {
+		struct stat st;
+		if(unlikely(stat((m_catpath + "/" + (*it)).c_str(), &st) != 0)) {
+			return false;
+		}
+		fingerprint_add(&hash, it->c_str(), it->size() + 1);
+		fingerprint_add(&hash, &(st.st_ino), sizeof(st.st_ino));
+		fingerprint_add(&hash, &(st.st_mtime), sizeof(st.st_mtime));
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+		fingerprint_add(&hash, &(st.st_mtim.tv_nsec), sizeof(st.st_mtim.tv_nsec));
+#endif
+		fingerprint_add(&hash, &(st.st_size), sizeof(st.st_size));
+	}
+	*fp = eix::format("%s:%s") % names.size() % hash;
+	return true;
 }
 
 bool MetadataCache::readCategory(Category *cat) {
+	// Let the reads of all files of the category overlap
+	prefetch_files(m_catpath, names);
 	for(WordVec::const_iterator it(names.begin());
 		likely(it != names.end()); ) {
 		Version *newest(NULLPTR);
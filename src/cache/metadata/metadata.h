@@ -15,11 +15,11 @@
 #include <string>
 
 #include "cache/base.h"
+#include "cache/common/assign_reader.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/sysutils.h"
 
 class Category;
-class Depend;
 class Package;
 class Version;
 
@@ -39,10 +39,10 @@ class MetadataCache : public BasicCache {
 		std::string m_catpath;
 		WordVec names;
 
-		typedef void (*x_get_keywords_slot_iuse_restrict_t)(const std::string& filename, std::string *keywords, std::string *slotname, std::string *iuse, std::string *restr, std::string *props, Depend *dep, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
-		typedef void (*x_read_file_t)(const char *filename, Package *pkg, BasicCache::ErrorCallback error_callback) ATTRIBUTE_NONNULL_;
-		x_get_keywords_slot_iuse_restrict_t x_get_keywords_slot_iuse_restrict;
-		x_read_file_t x_read_file;
+		/// Whether the files of the current category are read as flat files
+		bool read_flat;
+		/// Keeps the current "assign" type file; the methods using it are const
+		mutable AssignReader assign_reader;
 
 		void setType(PathType set_path_type, bool set_flat);
 		void setFlat(bool set_flat);
@@ -54,15 +54,19 @@ class MetadataCache : public BasicCache {
 		bool readCategory(Category *cat) ATTRIBUTE_NONNULL_;
 		void readCategoryFinalize();
 
+		bool can_read_in_parallel() const ATTRIBUTE_CONST_VIRTUAL {
+			return true;
+		}
+
+		bool fingerprint(std::string *fp) const ATTRIBUTE_NONNULL_;
+
 		const char *get_md5sum(const char *pkg_name, const char *ver_name) const ATTRIBUTE_NONNULL_;
 		time_t get_time(const char *pkg_name, const char *ver_name) const ATTRIBUTE_NONNULL_ {
 			return get_mtime((m_catpath + "/" + pkg_name + "-" + ver_name).c_str());
 		}
 
 		void get_version_info(const char *pkg_name, const char *ver_name, Version *version) const ATTRIBUTE_NONNULL_;
-		void get_common_info(const char *pkg_name, const char *ver_name, Package *pkg) const ATTRIBUTE_NONNULL_ {
-			(*x_read_file)((m_catpath + "/" + pkg_name + "-" + ver_name).c_str(), pkg, m_error_callback);
-		}
+		void get_common_info(const char *pkg_name, const char *ver_name, Package *pkg) const ATTRIBUTE_NONNULL_;
 
 		bool use_prefixport() const ATTRIBUTE_PURE;
 
@@ -15,8 +15,12 @@
 #include <string>
 
 #include "cache/base.h"
+#include "cache/common/assign_reader.h"
 #include "cache/common/ebuild_exec.h"
+#include "cache/common/ebuild_results.h"
+#include "cache/common/eclass_reader.h"
 #include "cache/common/flat_reader.h"
+#include "cache/common/md5_sums.h"
 #include "cache/common/selectors.h"
 #include "cache/metadata/metadata.h"
 #include "cache/parse/parse.h"
@@ -25,6 +29,7 @@
 #include "eixTk/likely.h"
 #include "eixTk/md5.h"
 #include "eixTk/null.h"
+#include "eixTk/snapshot.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 #include "eixTk/sysutils.h"
@@ -69,9 +74,13 @@ bool ParseCache::initialize(const string& name) {
 			return false;
 		}
 	}
+	if(try_parse) {
+		eclass_reader = new EclassReader(!nosubst, try_ebuild);
+	}
 	if(try_ebuild) {
 		ebuild_sh = use_sh;
 		ebuild_exec = new EbuildExec(use_sh, this);
+		ebuild_results = new EbuildResults(this);
 	}
 	while(++it_name != names.end()) {
 		MetadataCache *p(new MetadataCache);
@@ -82,6 +91,9 @@ bool ParseCache::initialize(const string& name) {
 		delete p;
 		return false;
 	}
+	if(!further.empty()) {
+		md5sums = Md5Sums::get();
+	}
 	return true;
 }
 
@@ -131,6 +143,8 @@ ParseCache::~ParseCache() {
 		delete ebuild_exec;
 		ebuild_exec = NULLPTR;
 	}
+	delete ebuild_results;
+	delete eclass_reader;
 }
 
 void ParseCache::setScheme(const char *prefix, const char *prefixport, const std::string& scheme) {
@@ -190,8 +204,16 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 	string keywords, restr, props, iuse, slot, eapi;
 	bool ok(try_parse);
 	if(ok || ebuild_sh) {
+		// Read the ebuild only once for the inherits and the variables
+		string content;
+		bool have_content(snapshot_read(fullpath, &content));
+		WordVec inherits;
+		if(ok && have_content) {
+			EclassReader::find_inherits(&inherits, content);
+		}
 		VarsReader::Flags flags(VarsReader::NONE);
-		if(!read_onetime_info) {
+		// With eclasses, variables of the ebuild must be known completely
+		if(!read_onetime_info && inherits.empty()) {
 			flags |= VarsReader::ONLY_KEYWORDS_SLOT;
 		}
 		WordMap env;
@@ -204,11 +226,25 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 			ebuild.useMap(&env);
 		}
 		string errtext;
-		if(!ebuild.read(fullpath, &errtext, false)) {
+		if(!(have_content ?
+			ebuild.readmem(content.c_str(), content.c_str() + content.size(), &errtext) :
+			ebuild.read(fullpath, &errtext, false))) {
 			m_error_callback(eix::format(_("Could not properly parse %s: %s")) % fullpath % errtext);
 		}
 
 		bool set_eapi(ebuild_sh);
+		if(ok && !inherits.empty()) {
+			if(eclass_dirs.empty()) {
+				getEclassDirs(&eclass_dirs);
+			}
+			if(unlikely(!eclass_reader->apply(&ebuild, inherits, eclass_dirs, &errtext))) {
+				if(ebuild_exec != NULLPTR) {
+					ok = false;
+				} else {
+					m_error_callback(eix::format(_("Could not properly parse %s: %s")) % fullpath % errtext);
+				}
+			}
+		}
 		if(ok) {
 			set_checking(&keywords, "KEYWORDS", ebuild, &ok);
 			set_checking(&slot, "SLOT", ebuild, &ok);
@@ -256,13 +292,22 @@ void ParseCache::parse_exec(const char *fullpath, const string& dirpath, bool re
 			used_type);
 	}
 	if(!ok) {
-		string *cachefile(ebuild_exec->make_cachefile(fullpath, dirpath, *pkg, *version, eapi));
-		if(likely(cachefile != NULLPTR)) {
-			flat_get_keywords_slot_iuse_restrict(*cachefile, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
-			flat_read_file(cachefile->c_str(), pkg, m_error_callback);
-			ebuild_exec->delete_cachefile();
+		string stored;
+		if(ebuild_results->lookup(&stored, fullpath)) {
+			// The ebuild and its eclasses did not change since it was executed
+			AssignReader *reader(ebuild_results->reader());
+			reader->get_keywords_slot_iuse_restrict(stored, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
+			reader->read_file(stored.c_str(), pkg, m_error_callback);
 		} else {
-			m_error_callback(eix::format(_("Could not properly execute %s")) % fullpath);
+			string *cachefile(ebuild_exec->make_cachefile(fullpath, dirpath, *pkg, *version, eapi));
+			if(likely(cachefile != NULLPTR)) {
+				flat_get_keywords_slot_iuse_restrict(*cachefile, &keywords, &slot, &iuse, &restr, &props, &(version->depend), m_error_callback);
+				flat_read_file(cachefile->c_str(), pkg, m_error_callback);
+				ebuild_results->store(fullpath, *cachefile);
+				ebuild_exec->delete_cachefile();
+			} else {
+				m_error_callback(eix::format(_("Could not properly execute %s")) % fullpath);
+			}
 		}
 	}
 	version->set_slotname(slot);
@@ -327,7 +372,8 @@ void ParseCache::readPackage(Category *cat, const string& pkg_name, const string
 		for(; likely(it != further.end()); ++it) {
 			const char *s((*it)->get_md5sum(pkg_name.c_str(), ver));
 			if(s != NULLPTR) {
-				if(verify_md5sum(full_path.c_str(), s)) {
+				if((md5sums != NULLPTR) ? md5sums->verify(full_path, s) :
+					verify_md5sum(full_path.c_str(), s)) {
 					break;
 				}
 				continue;
@@ -386,6 +432,9 @@ void ParseCache::readCategoryFinalize() {
 		likely(it != further.end()); ++it) {
 		(*it)->readCategoryFinalize();
 	}
+	if(md5sums != NULLPTR) {
+		md5sums->flush();
+	}
 	m_catname.clear();
 	m_catpath.clear();
 	m_packages.clear();
@@ -20,6 +20,9 @@
 
 class Category;
 class EbuildExec;
+class EbuildResults;
+class EclassReader;
+class Md5Sums;
 class VarsReader;
 class Version;
 
@@ -32,6 +35,10 @@ class ParseCache : public BasicCache {
 		FurtherWorks further_works;
 		bool try_parse, nosubst, ebuild_sh;
 		EbuildExec *ebuild_exec;
+		EbuildResults *ebuild_results;
+		EclassReader *eclass_reader;
+		Md5Sums *md5sums;
+		WordVec eclass_dirs;
 		WordVec m_packages;
 		std::string m_catpath;
 
@@ -44,7 +51,7 @@ class ParseCache : public BasicCache {
 		void readPackage(Category *cat, const std::string& pkg_name, const std::string& directory_path, const WordVec& files) ATTRIBUTE_NONNULL_;
 
 	public:
-		ParseCache() : BasicCache(), verbose(false), ebuild_exec(NULLPTR) {
+		ParseCache() : BasicCache(), verbose(false), ebuild_exec(NULLPTR), ebuild_results(NULLPTR), eclass_reader(NULLPTR), md5sums(NULLPTR) {
 		}
 
 		bool initialize(const std::string& name);
@@ -67,6 +74,11 @@ class ParseCache : public BasicCache {
 			return true;
 		}
 
+		// Only ebuild.sh writes into separate files; "ebuild depend" does not
+		bool can_split_categories() const ATTRIBUTE_PURE {
+			return ((ebuild_exec == NULLPTR) || ebuild_sh);
+		}
+
 		const char *getType() const;
 };
 
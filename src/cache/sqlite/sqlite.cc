@@ -7,28 +7,23 @@
 //   Emil Beinroth <emilbeinroth@gmx.net>
 //   Martin Väth <martin@mvath.de>
 
-// #define SQLITE_ONLY_DEBUG
-
 #include <config.h>
 
 #ifdef WITH_SQLITE
 #include <sqlite3.h>
 
-#include <cstdlib>
+#include <cstring>
 
-#ifdef SQLITE_ONLY_DEBUG
-#include <iostream>
-#endif
 #include <map>
 #include <string>
 
 #include "cache/sqlite/sqlite.h"
+#include "eixTk/diagnostics.h"
 #include "eixTk/formated.h"
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/stringutils.h"
-#include "eixTk/unused.h"
 #include "portage/basicversion.h"
 #include "portage/depend.h"
 #include "portage/package.h"
@@ -38,39 +33,15 @@
 using std::map;
 using std::string;
 
-#ifdef SQLITE_ONLY_DEBUG
-using std::cout;
-#endif
-
 /* Path to portage cache */
 #define PORTAGE_CACHE_PATH "/var/cache/edb/dep"
 
-
-
-/** All stuff related to our sqlite_callback()
-    Essentially, this is just a C-wrapper to get the implicit this argument in */
-
-SqliteCache *SqliteCache::callback_arg;
-
 inline static const char *welldefine(const char *s) ATTRIBUTE_CONST;
 
 inline static const char *welldefine(const char *s) {
 	return ((s != NULLPTR) ? s : "");
 }
 
-int sqlite_callback(void *NotUsed ATTRIBUTE_UNUSED, int argc, char **argv, char **azColName) {
-	UNUSED(NotUsed);
-#ifdef SQLITE_ONLY_DEBUG
-	for(int i(0); likely(i < argc); ++i) {
-		cout << eix::format("%s: %s = %s\n")
-			% i % azColName[i] % welldefine(argv[i]);
-	}
-#else
-	SqliteCache::callback_arg->sqlite_callback_cpp(argc, const_cast<const char **>(argv), const_cast<const char **>(azColName));
-#endif
-	return 0;
-}
-
 /**
     The following is all related to get the proper index for the lookups.
     The main idea is the following: We let
@@ -80,9 +51,9 @@ int sqlite_callback(void *NotUsed ATTRIBUTE_UNUSED, int argc, char **argv, char
     for all mandatory data is stored in SqliteCache::maxindex.
 
     The class TrueIndex and the static (and only) instance *true_index
-    is used to calculate the initial value of trueindex/maxindex
-    at the first database access by first filling it with default parameters
-    and - for the case that appropriate data is stored in azColName -
+    is used to calculate the value of trueindex/maxindex for each prepared
+    statement by first filling it with default parameters
+    and - for the case that appropriate data is stored in the column names -
     modifying this correspondingly: This has the advantage that if some
     portage versions use different names, we still have (hopefully correct)
     default values.
@@ -139,10 +110,11 @@ class TrueIndex : public TrueIndexMapper {
 			mapinit(18, SLOT,        "SLOT");
 		}
 
-		int calc(int argc, const char **azColName, SqliteCache::TrueIndexMap *trueindex) const ATTRIBUTE_NONNULL_ {
+		int calc(sqlite3_stmt *stmt, SqliteCache::TrueIndexMap *trueindex) const ATTRIBUTE_NONNULL_ {
 			*trueindex = default_trueindex;
+			int argc(sqlite3_column_count(stmt));
 			for(int i(0); i < argc; ++i) {
-				TrueIndexMapper::const_iterator it(find(azColName[i]));
+				TrueIndexMapper::const_iterator it(find(welldefine(sqlite3_column_name(stmt, i))));
 				if(it != end())
 					(*trueindex)[it->second] = i;
 			}
@@ -166,116 +138,131 @@ class TrueIndex : public TrueIndexMapper {
 			return max_index;
 		}
 
-		static const char *c_str(const char **argv, SqliteCache::TrueIndexMap *trueindex, const TrueIndexRes i) ATTRIBUTE_NONNULL((2)) {
-			int t((*trueindex)[i]);
+		/** The text is owned by sqlite and valid until the next step */
+		static const char *c_str(sqlite3_stmt *stmt, const SqliteCache::TrueIndexMap& trueindex, const TrueIndexRes i) ATTRIBUTE_NONNULL_ {
+			int t(trueindex[i]);
 			if(t < 0) {
 				return "";
 			}
-			return welldefine(argv[t]);
+			return welldefine(reinterpret_cast<const char *>(sqlite3_column_text(stmt, t)));
 		}
 };
 
 TrueIndex *SqliteCache::true_index = NULLPTR;
 
-void SqliteCache::sqlite_callback_cpp(int argc, const char **argv, const char **azColName) {
-	// If an earlier error occurred, we ignore later calls:
-	if(unlikely(sqlite_callback_error)) {
-		return;
-	}
-
-	if(maxindex == 0) {
-		if(unlikely(true_index == NULLPTR)) {
-			true_index = new TrueIndex;
-		}
-		maxindex = true_index->calc(argc, azColName, &trueindex);
-	}
-
-	if(argc <= trueindex[TrueIndex::NAME]) {
-		sqlite_callback_error = true;
-		m_error_callback(_("sqlite dataset does not contain a package name"));
-		return;
-	}
-	string catarg(TrueIndex::c_str(argv, &trueindex, TrueIndex::NAME));
-	if(argc <= maxindex) {
-		sqlite_callback_error = true;
-		m_error_callback(eix::format(_("sqlite dataset for %s is too small")) % catarg);
-		return;
-	}
-	string::size_type pos(catarg.find('/'));
-	if(pos == string::npos) {
-		sqlite_callback_error = true;
+bool SqliteCache::readRow(sqlite3_stmt *stmt, PackageTree *packagetree, Category *category) {
+	const char *catarg(TrueIndex::c_str(stmt, trueindex, TrueIndex::NAME));
+	const char *name_ver(std::strchr(catarg, '/'));
+	if(unlikely(name_ver == NULLPTR)) {
 		m_error_callback(eix::format(_("%r not of the form package/category-version")) % catarg);
-		return;
+		return false;
 	}
-	string name_ver(catarg, pos + 1);
-	catarg.resize(pos);
-	// Does the catarg match category?
-	// Currently, we do not add non-matching categories with this method.
-	Category *dest_cat;
-	if(unlikely(packagetree == NULLPTR)) {
-		if(cat_name != catarg) {
-			return;
+GCC_DIAG_OFF(sign-conversion)
+	string::size_type catlen(name_ver - catarg);
+GCC_DIAG_ON(sign-conversion)
+	++name_ver;
+	// Rows of the same category usually follow each other:
+	// Look up the destination only if the category has changed.
+	if((row_category.size() != catlen) ||
+		(row_category.compare(0, catlen, catarg, catlen) != 0)) {
+		row_category.assign(catarg, catlen);
+		if(category != NULLPTR) {
+			// The rows were already filtered by the query
+			row_dest = category;
+		} else if(never_add_categories) {
+			// Currently, we do not add non-matching categories with this method.
+			row_dest = packagetree->find(row_category);
+		} else {
+			row_dest = &((*packagetree)[row_category]);
 		}
-		dest_cat = category;
-	} else if(never_add_categories) {
-		dest_cat = packagetree->find(catarg);
-		if(unlikely(dest_cat == NULLPTR)) {
-			return;
-		}
-	} else {
-		dest_cat = &((*packagetree)[catarg]);
 	}
-	char **aux(ExplodeAtom::split(name_ver.c_str()));
-	if(unlikely(aux == NULLPTR)) {
+	if(unlikely(row_dest == NULLPTR)) {
+		return true;
+	}
+	const char *ver(ExplodeAtom::get_start_of_version(name_ver, false));
+	if(unlikely(ver == NULLPTR)) {
 		m_error_callback(eix::format(_("Can't split %r into package and version")) % name_ver);
-		return;
+		return true;
 	}
+GCC_DIAG_OFF(sign-conversion)
+	row_name.assign(name_ver, (ver - 1) - name_ver);
+GCC_DIAG_ON(sign-conversion)
 	/* Search for existing package */
-	Package *pkg(dest_cat->findPackage(aux[0]));
+	Package *pkg(row_dest->findPackage(row_name));
 
 	/* If none was found create one */
 	if(pkg == NULLPTR) {
-		pkg = dest_cat->addPackage(catarg, aux[0]);
+		pkg = row_dest->addPackage(row_category, row_name);
 	}
 
 	/* Create a new version and add it to package */
 	Version *version(new Version);
 	string errtext;
-	BasicVersion::ParseResult r(version->parseVersion(aux[1], &errtext));
+	BasicVersion::ParseResult r(version->parseVersion(ver, &errtext));
 	if(unlikely(r != BasicVersion::parsedOK)) {
 		m_error_callback(errtext);
 	}
 	if(unlikely(r == BasicVersion::parsedError)) {
 		delete version;
-	} else {
-		// reading slots and stability
-		version->set_slotname(TrueIndex::c_str(argv, &trueindex, TrueIndex::SLOT));
-		version->set_restrict(TrueIndex::c_str(argv, &trueindex, TrueIndex::RESTRICT));
-		version->set_properties(TrueIndex::c_str(argv, &trueindex, TrueIndex::PROPERTIES));
-		version->set_full_keywords(TrueIndex::c_str(argv, &trueindex, TrueIndex::KEYWORDS));
-		version->set_iuse(TrueIndex::c_str(argv, &trueindex, TrueIndex::IUSE));
-		version->depend.set(TrueIndex::c_str(argv, &trueindex, TrueIndex::DEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::RDEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::PDEPEND),
-			TrueIndex::c_str(argv, &trueindex, TrueIndex::HDEPEND),
-			false);
-		version->overlay_key = m_overlay_key;
-		pkg->addVersion(version);
-
-		/* For the newest version, add all remaining data */
-		if(*(pkg->latest()) == *version) {
-			pkg->homepage = TrueIndex::c_str(argv, &trueindex, TrueIndex::HOMEPAGE);
-			pkg->licenses = TrueIndex::c_str(argv, &trueindex, TrueIndex::LICENSE);
-			pkg->desc     = TrueIndex::c_str(argv, &trueindex, TrueIndex::DESCRIPTION);
+		return true;
+	}
+	// reading slots and stability
+	version->set_slotname(TrueIndex::c_str(stmt, trueindex, TrueIndex::SLOT));
+	version->set_restrict(TrueIndex::c_str(stmt, trueindex, TrueIndex::RESTRICT));
+	version->set_properties(TrueIndex::c_str(stmt, trueindex, TrueIndex::PROPERTIES));
+	version->set_full_keywords(TrueIndex::c_str(stmt, trueindex, TrueIndex::KEYWORDS));
+	version->set_iuse(TrueIndex::c_str(stmt, trueindex, TrueIndex::IUSE));
+	version->depend.set(TrueIndex::c_str(stmt, trueindex, TrueIndex::DEPEND),
+		TrueIndex::c_str(stmt, trueindex, TrueIndex::RDEPEND),
+		TrueIndex::c_str(stmt, trueindex, TrueIndex::PDEPEND),
+		TrueIndex::c_str(stmt, trueindex, TrueIndex::HDEPEND),
+		false);
+	version->overlay_key = m_overlay_key;
+	pkg->addVersion(version);
+
+	/* For the newest version, add all remaining data */
+	if(*(pkg->latest()) == *version) {
+		pkg->homepage = TrueIndex::c_str(stmt, trueindex, TrueIndex::HOMEPAGE);
+		pkg->licenses = TrueIndex::c_str(stmt, trueindex, TrueIndex::LICENSE);
+		pkg->desc     = TrueIndex::c_str(stmt, trueindex, TrueIndex::DESCRIPTION);
+	}
+	return true;
+}
+
+bool SqliteCache::readStatement(sqlite3_stmt *stmt, PackageTree *packagetree, Category *category) {
+	row_category.clear();
+	row_dest = category;
+	int rc;
+	while((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+		if(unlikely(!readRow(stmt, packagetree, category))) {
+			return false;
 		}
 	}
-	/* Free old split */
-	free(aux[0]);
-	free(aux[1]);
+	if(unlikely(rc != SQLITE_DONE)) {
+		m_error_callback(eix::format(_("sqlite error: %s")) %
+			sqlite3_errmsg(sqlite3_db_handle(stmt)));
+		return false;
+	}
+	return true;
+}
+
+/**
+    Bind the range of all keys of category catname to the prepared statement:
+    "cat/" <= key < "cat0" since '0' is the successor of '/'.
+**/
+static bool bind_category(sqlite3_stmt *stmt, const string& catname, string *from, string *to) ATTRIBUTE_NONNULL_;
+
+static bool bind_category(sqlite3_stmt *stmt, const string& catname, string *from, string *to) {
+	from->assign(catname);
+	from->append(1, '/');
+	to->assign(catname);
+	to->append(1, '0');
+	return ((sqlite3_reset(stmt) == SQLITE_OK) &&
+		(sqlite3_bind_text(stmt, 1, from->c_str(), -1, SQLITE_STATIC) == SQLITE_OK) &&
+		(sqlite3_bind_text(stmt, 2, to->c_str(), -1, SQLITE_STATIC) == SQLITE_OK));
 }
 
 bool SqliteCache::readCategories(PackageTree *pkgtree, const char *catname, Category *cat) {
-	char *errormessage(NULLPTR);
 	string sqlitefile(m_prefix + PORTAGE_CACHE_PATH + m_scheme);
 	// Cut all trailing '/' and append ".sqlite" to the name
 	string::size_type pos(sqlitefile.find_last_not_of('/'));
@@ -293,20 +280,57 @@ bool SqliteCache::readCategories(PackageTree *pkgtree, const char *catname, Cate
 		m_error_callback(eix::format(_("Can't open cache file %s")) % sqlitefile);
 		return false;
 	}
-	callback_arg = this;
-	sqlite_callback_error = false;
-	maxindex = 0;
-	packagetree = pkgtree;
-	category = cat;
-	cat_name = catname;
-	rc = sqlite3_exec(db, "select * from portage_packages", sqlite_callback, NULLPTR, &errormessage);
+	// The statement for all rows determines also the column indices
+	sqlite3_stmt *stmt;
+	if(unlikely(sqlite3_prepare_v2(db, "select * from portage_packages", -1, &stmt, NULLPTR) != SQLITE_OK)) {
+		m_error_callback(eix::format(_("sqlite error: %s")) % sqlite3_errmsg(db));
+		sqlite3_close(db);
+		return false;
+	}
+	if(unlikely(true_index == NULLPTR)) {
+		true_index = new TrueIndex;
+	}
+	maxindex = true_index->calc(stmt, &trueindex);
+	int argc(sqlite3_column_count(stmt));
+	bool ok(true);
+	if(unlikely(argc <= trueindex[TrueIndex::NAME])) {
+		m_error_callback(_("sqlite dataset does not contain a package name"));
+		ok = false;
+	} else if(unlikely(argc <= maxindex)) {
+		m_error_callback(eix::format(_("sqlite dataset for %s is too small")) % sqlitefile);
+		ok = false;
+	} else if((pkgtree == NULLPTR) || never_add_categories) {
+		// Let sqlite select the categories we need: The package key is
+		// usually UNIQUE and thus indexed so that this avoids a full scan
+		string query("select * from portage_packages where \"");
+		query.append(welldefine(sqlite3_column_name(stmt, trueindex[TrueIndex::NAME])));
+		query.append("\" >= ?1 and \"");
+		query.append(welldefine(sqlite3_column_name(stmt, trueindex[TrueIndex::NAME])));
+		query.append("\" < ?2");
+		sqlite3_finalize(stmt);
+		if(unlikely(sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, NULLPTR) != SQLITE_OK)) {
+			m_error_callback(eix::format(_("sqlite error: %s")) % sqlite3_errmsg(db));
+			sqlite3_close(db);
+			return false;
+		}
+		string from, to;
+		if(pkgtree == NULLPTR) {
+			ok = bind_category(stmt, catname, &from, &to) &&
+				readStatement(stmt, NULLPTR, cat);
+		} else {
+			for(PackageTree::iterator it(pkgtree->begin());
+				likely(ok && (it != pkgtree->end())); ++it) {
+				ok = bind_category(stmt, it->first, &from, &to) &&
+					readStatement(stmt, NULLPTR, it->second);
+			}
+		}
+	} else {
+		ok = readStatement(stmt, pkgtree, NULLPTR);
+	}
+	sqlite3_finalize(stmt);
 	sqlite3_close(db);
 	trueindex.clear();
-	if(rc != SQLITE_OK) {
-		sqlite_callback_error = true;
-		m_error_callback(eix::format(_("sqlite error: %s")) % errormessage);
-	}
-	return !sqlite_callback_error;
+	return ok;
 }
 
 #else /* Not WITH_SQLITE */
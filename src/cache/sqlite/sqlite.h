@@ -10,42 +10,41 @@
 #ifndef SRC_CACHE_SQLITE_SQLITE_H_
 #define SRC_CACHE_SQLITE_SQLITE_H_ 1
 
+#include <string>
 #include <vector>
 
 #include "cache/base.h"
+#include "eixTk/null.h"
 
 class Category;
 class PackageTree;
 class TrueIndex;
+struct sqlite3_stmt;
 
 class SqliteCache : public BasicCache {
-		friend int sqlite_callback(void *NotUsed, int argc, char **argv, char **azColName);
-
 	public:  // actually private, but this is too clumsy...
 		typedef std::vector<int> TrueIndexMap;
 
 	private:
 		bool never_add_categories;
-		void sqlite_callback_cpp(int argc, const char **argv, const char **azColName) ATTRIBUTE_NONNULL((4));
 		TrueIndexMap trueindex;
 		int maxindex;
-
-		/** This variable is actually the this-parameter for our sqlite_callback function.
-		    Note that this makes readCategories non-reentrant. */
-		static SqliteCache *callback_arg;
-		/** Our sqlite_callback() will set this to true in case of an error. */
-		bool sqlite_callback_error;
-		/** Parameter passing to sqlite_callback() */
-		PackageTree *packagetree;
-		Category *category;
-		const char *cat_name;
 		static TrueIndex *true_index;
 
+		/** Buffers which are reused for every row to avoid allocations */
+		std::string row_category, row_name;
+		Category *row_dest;
+
+		/** Read all rows of the prepared statement into category or,
+		    if category is NULLPTR, into the matching category of packagetree */
+		bool readStatement(sqlite3_stmt *stmt, PackageTree *packagetree, Category *category) ATTRIBUTE_NONNULL((2));
+		bool readRow(sqlite3_stmt *stmt, PackageTree *packagetree, Category *category) ATTRIBUTE_NONNULL((2));
+
 	public:
-		SqliteCache() : BasicCache(), never_add_categories(true) {
+		SqliteCache() : BasicCache(), never_add_categories(true), row_dest(NULLPTR) {
 		}
 
-		explicit SqliteCache(bool add_categories) : BasicCache(), never_add_categories(!add_categories) {
+		explicit SqliteCache(bool add_categories) : BasicCache(), never_add_categories(!add_categories), row_dest(NULLPTR) {
 		}
 
 		bool can_read_multiple_categories() const ATTRIBUTE_CONST_VIRTUAL {
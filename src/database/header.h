@@ -58,7 +58,7 @@ class DBHeader {
 		static const char *magic;
 
 		/** Current version of database-format and what we accept */
-		static CONSTEXPR DBVersion current = 34;
+		static CONSTEXPR DBVersion current = 35;
 		static const DBVersion accept[];
 
 		DBVersion version;  /**< Version of the db. */
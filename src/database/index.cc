@@ -0,0 +1,103 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <algorithm>
+#include <string>
+
+#include "database/index.h"
+#include "database/io.h"
+#include "eixTk/eixint.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+
+using std::lower_bound;
+using std::string;
+using std::upper_bound;
+
+static bool has_prefix(const string& s, const string& prefix) ATTRIBUTE_PURE;
+
+static bool has_prefix(const string& s, const string& prefix) {
+	return (s.compare(0, prefix.size(), prefix) == 0);
+}
+
+static bool offset_less(eix::OffsetType offset, const DBIndex::CategoryEntry& cat) ATTRIBUTE_PURE;
+
+static bool offset_less(eix::OffsetType offset, const DBIndex::CategoryEntry& cat) {
+	return (offset < cat.offset);
+}
+
+bool DBIndex::load(CategoryEntry *cat) {
+	if(cat->loaded) {
+		return true;
+	}
+	if(unlikely((m_db == NULLPTR) || !m_db->read_index_table(cat, NULLPTR))) {
+		return false;
+	}
+	cat->loaded = true;
+	return true;
+}
+
+bool DBIndex::findInTable(Hits *hits, CategoryEntry *cat, const string& name, bool prefix) {
+	if(unlikely(!load(cat))) {
+		return false;
+	}
+	const PackageTable& table(cat->packages);
+	for(PackageTable::const_iterator it(lower_bound(table.begin(), table.end(), PackageEntry(name, 0)));
+		likely(it != table.end()); ++it) {
+		if(prefix ? !has_prefix(it->name, name) : (it->name != name)) {
+			break;
+		}
+		hits->insert(it->offset);
+	}
+	return true;
+}
+
+bool DBIndex::findCategory(Hits *hits, const string& cat, bool prefix) {
+	for(CategoryTable::iterator it(lower_bound(categories.begin(), categories.end(), CategoryEntry(cat, 0)));
+		likely(it != categories.end()); ++it) {
+		if(prefix ? !has_prefix(it->name, cat) : (it->name != cat)) {
+			break;
+		}
+		if(unlikely(!findInTable(hits, &(*it), "", true))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DBIndex::findName(Hits *hits, const string& name, bool prefix) {
+	for(CategoryTable::iterator it(categories.begin());
+		likely(it != categories.end()); ++it) {
+		if(unlikely(!findInTable(hits, &(*it), name, prefix))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DBIndex::findPackage(Hits *hits, const string& cat, const string& name, bool prefix) {
+	CategoryTable::iterator it(lower_bound(categories.begin(), categories.end(), CategoryEntry(cat, 0)));
+	if((it == categories.end()) || (it->name != cat)) {
+		return true;
+	}
+	return findInTable(hits, &(*it), name, prefix);
+}
+
+const string& DBIndex::categoryAt(eix::OffsetType offset) const {
+	static const string *not_found = NULLPTR;
+	// Categories are stored in the file in the order of their names
+	CategoryTable::const_iterator it(upper_bound(categories.begin(), categories.end(), offset, offset_less));
+	if(unlikely(it == categories.begin())) {
+		if(not_found == NULLPTR) {
+			not_found = new string;
+		}
+		return *not_found;
+	}
+	return (--it)->name;
+}
@@ -0,0 +1,93 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_DATABASE_INDEX_H_
+#define SRC_DATABASE_INDEX_H_ 1
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "eixTk/eixint.h"
+#include "eixTk/null.h"
+
+class Database;
+
+/** Representation of the index section of the database.
+ * It maps category names and package names to file offsets such that
+ * exact and prefix lookups need not walk through the whole file.
+ * The package tables are only read from the database when needed. */
+class DBIndex {
+		friend class Database;
+
+	public:
+		/// Offsets of the packages (of their length prefix) in the file
+		typedef std::set<eix::OffsetType> Hits;
+
+		class PackageEntry {
+			public:
+				std::string name;
+				eix::OffsetType offset;
+
+				PackageEntry(const std::string& n, eix::OffsetType o) : name(n), offset(o) {
+				}
+
+				bool operator<(const PackageEntry& e) const {
+					return (name < e.name);
+				}
+		};
+
+		typedef std::vector<PackageEntry> PackageTable;
+
+		class CategoryEntry {
+			public:
+				std::string name;
+				eix::OffsetType offset;  ///< offset of the category header
+				eix::Treesize size;      ///< number of packages
+				eix::OffsetType table;   ///< offset of the package table
+				bool loaded;
+				PackageTable packages;   ///< sorted by name if loaded
+
+				CategoryEntry(const std::string& n, eix::OffsetType o)
+					: name(n), offset(o), size(0), table(0), loaded(true) {
+				}
+
+				bool operator<(const CategoryEntry& e) const {
+					return (name < e.name);
+				}
+		};
+
+		typedef std::vector<CategoryEntry> CategoryTable;
+
+		/// Categories, sorted by name (and hence by offset)
+		CategoryTable categories;
+
+		DBIndex() : m_db(NULLPTR) {
+		}
+
+		/// Read the package table of cat if not done yet
+		bool load(CategoryEntry *cat) ATTRIBUTE_NONNULL_;
+
+		/// Add all packages with matching category to hits
+		bool findCategory(Hits *hits, const std::string& cat, bool prefix) ATTRIBUTE_NONNULL_;
+
+		/// Add all packages with matching name (in any category) to hits
+		bool findName(Hits *hits, const std::string& name, bool prefix) ATTRIBUTE_NONNULL_;
+
+		/// Add all packages with exact category and matching name to hits
+		bool findPackage(Hits *hits, const std::string& cat, const std::string& name, bool prefix) ATTRIBUTE_NONNULL_;
+
+		/// Return the name of the category containing the package at offset
+		const std::string& categoryAt(eix::OffsetType offset) const;
+
+	protected:
+		Database *m_db;
+
+		bool findInTable(Hits *hits, CategoryEntry *cat, const std::string& name, bool prefix) ATTRIBUTE_NONNULL_;
+};
+
+#endif  // SRC_DATABASE_INDEX_H_
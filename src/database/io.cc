@@ -7,45 +7,364 @@
 
 #include <config.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef WITH_ZLIB
+#include <zlib.h>
+#endif
+
 #include <cstdio>
+#include <cstring>
 
 #include <string>
 #include <vector>
 
 #include "database/header.h"
 #include "database/io.h"
-#include "eixTk/auto_list.h"
+#include "eixTk/constexpr.h"
 #include "eixTk/diagnostics.h"
 #include "eixTk/eixint.h"
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/stringutils.h"
+#include "eixTk/unused.h"
 
 using std::string;
 using std::vector;
 
+/**
+A compressed database consists of compressed_magic followed by blocks.
+Each block starts with its uncompressed and compressed size
+(4 bytes each, most significant first) followed by the compressed data.
+The blocks can be decompressed independently.
+**/
+static const char compressed_magic[] = "eixz";
+static CONSTEXPR size_t compressed_magic_size = 4;
+static CONSTEXPR size_t compressed_block_size = 1024 * 1024;
+
+#ifdef WITH_ZLIB
+static eix::UNumber get_size(const char *p) ATTRIBUTE_NONNULL_ ATTRIBUTE_PURE;
+static void put_size(eix::UChar *p, eix::UNumber s) ATTRIBUTE_NONNULL_;
+
+static eix::UNumber get_size(const char *p) {
+	const eix::UChar *s(reinterpret_cast<const eix::UChar *>(p));
+	return ((eix::UNumber(s[0]) << 24) | (eix::UNumber(s[1]) << 16) |
+		(eix::UNumber(s[2]) << 8) | eix::UNumber(s[3]));
+}
+
+static void put_size(eix::UChar *p, eix::UNumber s) {
+	p[0] = eix::UChar((s >> 24) & 0xFFU);
+	p[1] = eix::UChar((s >> 16) & 0xFFU);
+	p[2] = eix::UChar((s >> 8) & 0xFFU);
+	p[3] = eix::UChar(s & 0xFFU);
+}
+#endif
+
+const char *File::compression_name(Compression compression) {
+	switch(compression) {
+		case COMPRESS_ZLIB:
+			return "zlib";
+		default:
+			return "none";
+	}
+}
+
+bool File::compression_from_name(Compression *compression, const string& name) {
+	if(name.empty() || (name == "none")) {
+		*compression = COMPRESS_NONE;
+		return true;
+	}
+#ifdef WITH_ZLIB
+	if(name == "zlib") {
+		*compression = COMPRESS_ZLIB;
+		return true;
+	}
+#endif
+	return false;
+}
+
+/**
+The block table of a compressed file and the recently uncompressed blocks,
+so that only the blocks actually read are uncompressed
+**/
+class File::BlockCache {
+	public:
+		class Block {
+			public:
+				/// The offset in the uncompressed data
+				eix::OffsetType offset;
+
+				/// The compressed data in the mapping
+				const char *data;
+
+				/// The compressed and uncompressed size
+				eix::UNumber len, size;
+		};
+		typedef vector<Block> Table;
+		Table table;
+
+		BlockCache() : clock(0) {
+		}
+
+		/// @return the uncompressed data of table[i] or NULLPTR
+		const char *get(Table::size_type i);
+
+	private:
+		class Slot {
+			public:
+				Table::size_type index;
+
+				/// The time of the last access; 0 if the slot is empty
+				eix::UNumber used;
+
+				vector<char> data;
+
+				Slot() : index(0), used(0) {
+				}
+		};
+
+		/// Lazily read data can refer to some previous blocks
+		Slot slots[4];
+		eix::UNumber clock;
+};
+
+const char *File::BlockCache::get(Table::size_type i) {
+	Slot *victim(slots);
+	for(Slot *slot(slots); likely(slot != slots + (sizeof(slots) / sizeof(slots[0]))); ++slot) {
+		if((slot->used != 0) && (slot->index == i)) {
+			slot->used = ++clock;
+			return &(slot->data[0]);
+		}
+		if(slot->used < victim->used) {
+			victim = slot;
+		}
+	}
+#ifdef WITH_ZLIB
+	// The current block is the most recently used and thus never the victim
+	const Block& block(table[i]);
+	victim->data.resize(block.size);
+	uLongf size(block.size);
+	if(unlikely((::uncompress(reinterpret_cast<Bytef *>(&(victim->data[0])), &size,
+		reinterpret_cast<const Bytef *>(block.data), block.len) != Z_OK) ||
+		(size != block.size))) {
+		victim->used = 0;
+		return NULLPTR;
+	}
+	victim->index = i;
+	victim->used = ++clock;
+	return &(victim->data[0]);
+#else
+	return NULLPTR;
+#endif
+}
+
+bool File::open_blocks() {
+#ifdef WITH_ZLIB
+	blocks = new BlockCache;
+	const char *end(mmap_begin + mmap_size);
+	eix::OffsetType total(0);
+	for(const char *p(mmap_begin + compressed_magic_size); p != end; ) {
+		if(unlikely(end - p < 8)) {
+			return false;
+		}
+		BlockCache::Block block;
+		block.offset = total;
+		block.size = get_size(p);
+		block.len = get_size(p + 4);
+		block.data = p + 8;
+		if(unlikely((block.size == 0) || (eix::UNumber(end - block.data) < block.len))) {
+			return false;
+		}
+		blocks->table.push_back(block);
+		total += block.size;
+		p = block.data + block.len;
+	}
+	if(unlikely(total == 0)) {
+		return false;
+	}
+	map_size = total;
+	m_compression = COMPRESS_ZLIB;
+	return load_block(0);
+#else
+	return false;
+#endif
+}
+
+bool File::load_block(eix::OffsetType offset) {
+	// Find the last block starting not after offset
+	const BlockCache::Table& table(blocks->table);
+	BlockCache::Table::size_type low(0), high(table.size());
+	while(high - low > 1) {
+		BlockCache::Table::size_type middle(low + (high - low) / 2);
+		if(table[middle].offset <= offset) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	const char *data(blocks->get(low));
+	if(unlikely(data == NULLPTR)) {
+		return false;
+	}
+	map_begin = data;
+	map_end = data + table[low].size;
+	map_offset = table[low].offset;
+	map_curr = map_begin + (offset - map_offset);
+	return true;
+}
+
+bool File::next_block() {
+	eix::OffsetType offset(map_offset + (map_end - map_begin));
+	return ((blocks != NULLPTR) && (offset < map_size) && likely(load_block(offset)));
+}
+
+int File::getch_block() {
+	if(likely(next_block())) {
+		return static_cast<eix::UChar>(*(map_curr++));
+	}
+	return EOF;
+}
+
 bool File::openread(const char *name) {
-	return ((fp = fopen(name, "rb")) != NULLPTR);
+	m_compression = COMPRESS_NONE;
+	int fd(open(name, O_RDONLY));
+	if(unlikely(fd == -1)) {
+		return false;
+	}
+	struct stat st;
+	if(likely((fstat(fd, &st) == 0) && (st.st_size > 0))) {
+GCC_DIAG_OFF(sign-conversion)
+		void *buffer = mmap(NULLPTR, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+GCC_DIAG_ON(sign-conversion)
+GCC_DIAG_OFF(old-style-cast)
+		if(likely(buffer != MAP_FAILED)) {
+GCC_DIAG_ON(old-style-cast)
+			close(fd);
+			mmap_begin = static_cast<const char *>(buffer);
+			mmap_size = st.st_size;
+			if(likely((st.st_size < eix::OffsetType(compressed_magic_size)) ||
+				(std::memcmp(mmap_begin, compressed_magic, compressed_magic_size) != 0))) {
+				map_begin = map_curr = mmap_begin;
+				map_end = mmap_begin + mmap_size;
+				map_size = mmap_size;
+				return true;
+			}
+			// Blocks are uncompressed only when they are read
+			return open_blocks();
+		}
+	}
+	// Empty or unmappable file: fall back to stdio
+	if(likely((fp = fdopen(fd, "rb")) != NULLPTR)) {
+		return true;
+	}
+	close(fd);
+	return false;
 }
 
-bool File::openwrite(const char *name) {
-	return ((fp = fopen(name, "wb")) != NULLPTR);
+bool File::openwrite(const char *name, Compression compression) {
+	if(unlikely((fp = fopen(name, "wb")) == NULLPTR)) {
+		return false;
+	}
+#ifdef WITH_ZLIB
+	m_compression = compression;
+	if(compression != COMPRESS_NONE) {
+		// Collect the uncompressed data in a temporary file
+		compress_fp = fp;
+		if(unlikely((fp = tmpfile()) == NULLPTR)) {
+			return false;
+		}
+	}
+#else
+	UNUSED(compression);
+#endif
+	// Most data comes in small pieces: Avoid many small writes
+	setvbuf(fp, NULLPTR, _IOFBF, 128 * 1024);
+	return true;
+}
+
+bool File::closewrite(string *errtext) {
+	bool ok(fflush(fp) == 0);
+#ifdef WITH_ZLIB
+	if(likely(ok) && (compress_fp != NULLPTR)) {
+		rewind(fp);
+		ok = (fwrite(compressed_magic, 1, compressed_magic_size, compress_fp) == compressed_magic_size);
+		vector<Bytef> in(compressed_block_size);
+		vector<Bytef> out(8 + compressBound(compressed_block_size));
+		size_t size;
+		while(likely(ok) && ((size = fread(&(in[0]), 1, compressed_block_size, fp)) != 0)) {
+			uLongf len(out.size() - 8);
+			ok = (compress2(&(out[8]), &len, &(in[0]), size, Z_DEFAULT_COMPRESSION) == Z_OK);
+			if(likely(ok)) {
+				put_size(&(out[0]), size);
+				put_size(&(out[4]), len);
+				ok = (fwrite(&(out[0]), 1, len + 8, compress_fp) == len + 8);
+			}
+		}
+		ok = (ok && !ferror(fp));
+	}
+#endif
+	if(unlikely(fclose(fp) != 0)) {
+		ok = false;
+	}
+	fp = NULLPTR;
+	if(compress_fp != NULLPTR) {
+		if(unlikely(fclose(compress_fp) != 0)) {
+			ok = false;
+		}
+		compress_fp = NULLPTR;
+	}
+	if(unlikely(!ok)) {
+		writeError(errtext);
+	}
+	return ok;
 }
 
 File::~File() {
+	delete blocks;
+	if(mmap_begin != NULLPTR) {
+GCC_DIAG_OFF(cast-qual)
+GCC_DIAG_OFF(sign-conversion)
+		munmap(const_cast<char *>(mmap_begin), mmap_size);
+GCC_DIAG_ON(sign-conversion)
+GCC_DIAG_ON(cast-qual)
+	}
 	if(likely(fp != NULLPTR)) {
 		fclose(fp);
 	}
+	if(compress_fp != NULLPTR) {
+		fclose(compress_fp);
+	}
 }
 
 bool File::seek(eix::OffsetType offset, int whence, std::string *errtext) {
+	if(likely(map_begin != NULLPTR)) {
+		eix::OffsetType pos(offset);
+		if(whence == SEEK_CUR) {
+			pos += tell();
+		} else if(whence == SEEK_END) {
+			pos += map_size;
+		}
+		if(likely((pos >= map_offset) && (pos <= map_offset + (map_end - map_begin)))) {
+			map_curr = map_begin + (pos - map_offset);
+			return true;
+		}
+		if(likely((pos >= 0) && (pos <= map_size) && (blocks != NULLPTR) &&
+			load_block(pos))) {
+			return true;
+		}
+	} else {
 #ifdef HAVE_FSEEKO
-	if(likely(fseeko(fp, offset, whence) == 0))
+		if(likely(fseeko(fp, offset, whence) == 0))
 #else
-	if(likely(fseek(fp, offset, whence) == 0))
+		if(likely(fseek(fp, offset, whence) == 0))
 #endif
-		return true;
+			return true;
+	}
 	if(errtext != NULLPTR) {
 		*errtext = _("fseek failed");
 	}
@@ -53,6 +372,9 @@ bool File::seek(eix::OffsetType offset, int whence, std::string *errtext) {
 }
 
 eix::OffsetType File::tell() {
+	if(likely(map_begin != NULLPTR)) {
+		return (map_offset + (map_curr - map_begin));
+	}
 #ifdef HAVE_FSEEKO
 	// We rely on autoconf whose documentation states:
 	// All systems with fseeko() also supply ftello()
@@ -62,6 +384,39 @@ eix::OffsetType File::tell() {
 #endif
 }
 
+bool File::read(char *s, string::size_type len) {
+	if(likely(map_begin != NULLPTR)) {
+GCC_DIAG_OFF(sign-conversion)
+		string::size_type avail;
+		while(unlikely(len > (avail = string::size_type(map_end - map_curr)))) {
+GCC_DIAG_ON(sign-conversion)
+			std::memcpy(s, map_curr, avail);
+			s += avail;
+			len -= avail;
+			map_curr = map_end;
+			if(unlikely(!next_block())) {
+				return false;
+			}
+		}
+		std::memcpy(s, map_curr, len);
+		map_curr += len;
+		return true;
+	}
+	return (fread(s, sizeof(*s), len, fp) == len);
+}
+
+bool File::read_assign(string *s, string::size_type len) {
+GCC_DIAG_OFF(sign-conversion)
+	if(likely((map_begin != NULLPTR) && (len <= string::size_type(map_end - map_curr)))) {
+GCC_DIAG_ON(sign-conversion)
+		s->assign(map_curr, len);
+		map_curr += len;
+		return true;
+	}
+	s->resize(len);
+	return ((len == 0) || read(&((*s)[0]), len));
+}
+
 bool File::read_string_plain(char *s, string::size_type len, string *errtext) {
 	if(likely(read(s, len))) {
 		return true;
@@ -80,7 +435,7 @@ bool File::write_string_plain(const string& str, string *errtext) {
 
 void File::readError(string *errtext) {
 	if(errtext != NULLPTR) {
-		*errtext = (feof(fp) ?
+		*errtext = (((map_begin != NULLPTR) ? (tell() == map_size) : feof(fp)) ?
 			_("error while reading from database: end of file") :
 			_("error while reading from database"));
 	}
@@ -103,20 +458,16 @@ bool Database::readUChar(eix::UChar *c, string *errtext) {
 }
 
 bool Database::writeUChar(eix::UChar c, string *errtext) {
-	if(counting) {
-		++counter;
-	} else if(unlikely(!putch(c))) {
-		writeError(errtext);
-		return false;
+	if(likely(put(c))) {
+		return true;
 	}
-	return true;
+	writeError(errtext);
+	return false;
 }
 
 bool Database::write_string_plain(const string& str, string *errtext) {
-	if(counting) {
-GCC_DIAG_OFF(sign-conversion)
-		counter += str.size();
-GCC_DIAG_ON(sign-conversion)
+	if(buffer != NULLPTR) {
+		buffer->append(str);
 		return true;
 	}
 	return File::write_string_plain(str, errtext);
@@ -127,12 +478,10 @@ bool Database::read_string(string *s, string *errtext) {
 	if(unlikely(!read_num(&len, errtext))) {
 		return false;
 	}
-	eix::auto_list<char> buf(new char[len + 1]);
-	buf.get()[len] = 0;
-	if(likely(read_string_plain(buf.get(), len, errtext))) {
-		*s = buf.get();
+	if(likely(read_assign(s, len))) {
 		return true;
 	}
+	readError(errtext);
 	return false;
 }
 
@@ -174,14 +523,14 @@ bool Database::read_hash_words(const StringHash& hash, string *s, string *errtex
 		return false;
 	}
 	for(; e != 0; --e) {
-		string r;
-		if(unlikely(!read_hash_string(hash, &r, errtext))) {
+		StringHash::size_type i;
+		if(unlikely(!read_num(&i, errtext))) {
 			return false;
 		}
 		if(!s->empty()) {
 			s->append(1, ' ');
 		}
-		s->append(r);
+		s->append(hash[i]);
 	}
 	return true;
 }
@@ -12,6 +12,7 @@
 
 #include <string>
 
+#include "database/index.h"
 #include "eixTk/diagnostics.h"
 #include "eixTk/eixint.h"
 #include "eixTk/likely.h"
@@ -34,20 +35,87 @@ class Version;
 #define MAGICNUMCHAR 0xFFU
 
 class File {
+	public:
+		enum Compression {
+			COMPRESS_NONE,
+			COMPRESS_ZLIB
+		};
+
 	private:
 		FILE *fp;
+
+		/// For compressed writing, fp is a temporary file copied into this
+		FILE *compress_fp;
+
+		Compression m_compression;
+
+		/// The mmapped file
+		const char *mmap_begin;
+		eix::OffsetType mmap_size;
+
+		/// For a compressed file, the block table and recently used blocks
+		class BlockCache;
+		BlockCache *blocks;
+
+		/// Offset of map_begin and total size of the (uncompressed) data
+		eix::OffsetType map_offset, map_size;
+
 		bool seek(eix::OffsetType offset, int whence, std::string *errtext);
 
+		/// Read the block table of a compressed file
+		bool open_blocks();
+
+		/// Make the block containing offset the current window
+		bool load_block(eix::OffsetType offset);
+
+		/// Make the block following the current window the current window
+		bool next_block();
+
+		/// Called by getch() at the end of the current window
+		int getch_block();
+
+	protected:
+		/// If openread() succeeds with mmap, the file is accessed through
+		/// this window: the whole file or the current uncompressed block
+		const char *map_begin, *map_end, *map_curr;
+
 	public:
-		File() : fp(NULLPTR) {
+		File() : fp(NULLPTR), compress_fp(NULLPTR), m_compression(COMPRESS_NONE), mmap_begin(NULLPTR), mmap_size(0), blocks(NULLPTR), map_offset(0), map_size(0), map_begin(NULLPTR), map_end(NULLPTR), map_curr(NULLPTR) {
 		}
 
 		~File();
 
 		bool openread(const char *name) ATTRIBUTE_NONNULL_;
-		bool openwrite(const char *name) ATTRIBUTE_NONNULL_;
+		bool openwrite(const char *name, Compression compression) ATTRIBUTE_NONNULL_;
+		bool openwrite(const char *name) ATTRIBUTE_NONNULL_ {
+			return openwrite(name, COMPRESS_NONE);
+		}
+
+		/// Finish writing; only now a compressed file is actually written
+		bool closewrite(std::string *errtext);
+
+		/// The compression of the file opened with openread() or openwrite()
+		Compression compression() const {
+			return m_compression;
+		}
+
+		static const char *compression_name(Compression compression) ATTRIBUTE_CONST;
+
+		/// @return false if name is not a (supported) compression
+		static bool compression_from_name(Compression *compression, const std::string& name) ATTRIBUTE_NONNULL_;
+
+		/// Is the file accessed through a memory mapping?
+		bool mapped() const {
+			return (map_begin != NULLPTR);
+		}
 
 		int getch() {
+			if(likely(map_begin != NULLPTR)) {
+				if(likely(map_curr != map_end)) {
+					return static_cast<eix::UChar>(*(map_curr++));
+				}
+				return getch_block();
+			}
 			return fgetc(fp);
 		}
 
@@ -55,9 +123,10 @@ class File {
 			return (fputc(c, fp) != EOF);
 		}
 
-		bool read(char *s, std::string::size_type len) {
-			return (fread(s, sizeof(*s), len, fp) == len);
-		}
+		bool read(char *s, std::string::size_type len) ATTRIBUTE_NONNULL_;
+
+		/// Read len bytes directly into *s without an intermediate buffer
+		bool read_assign(std::string *s, std::string::size_type len) ATTRIBUTE_NONNULL_;
 
 		bool write(const std::string str) {
 			return (fwrite(static_cast<const void *>(str.c_str()), sizeof(*(str.c_str())), str.size(), fp) == str.size());
@@ -74,6 +143,10 @@ class File {
 			return seek(offset, SEEK_SET, errtext);
 		}
 
+		bool seekend(eix::OffsetType offset, std::string *errtext) {
+			return seek(offset, SEEK_END, errtext);
+		}
+
 		eix::OffsetType tell();
 
 		void readError(std::string *errtext);
@@ -81,11 +154,21 @@ class File {
 };
 
 class Database : public File {
+		friend class DBIndex;
+		friend class Depend;
 		friend class PackageReader;
 
 	private:
-		bool counting;
-		eix::OffsetType counter;
+		/// If not NULLPTR, the output is collected here instead of being written
+		std::string *buffer;
+
+		bool put(eix::UChar c) {
+			if(buffer != NULLPTR) {
+				buffer->push_back(c);
+				return true;
+			}
+			return putch(c);
+		}
 
 		bool read_Part(BasicPart *b, std::string *errtext) ATTRIBUTE_NONNULL((2));
 		bool write_Part(const BasicPart& n, std::string *errtext);
@@ -126,12 +209,18 @@ class Database : public File {
 		bool read_hash_words(const StringHash& hash, WordVec *s, std::string *errtext) ATTRIBUTE_NONNULL((3));
 		bool read_hash_words(const StringHash& hash, std::string *s, std::string *errtext) ATTRIBUTE_NONNULL((3));
 
-		bool read_iuse(const StringHash& hash, IUseSet *iuse, std::string *errtext) ATTRIBUTE_NONNULL((3));
+		/// If lazy, the words are only parsed when iuse is used; hash must be kept
+		bool read_iuse(const StringHash& hash, IUseSet *iuse, bool lazy, std::string *errtext) ATTRIBUTE_NONNULL((3));
 
-		bool read_version(Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		/// If lazy, IUSE and dependencies are only decoded when needed.
+		/// Then the database and hdr must be kept until v is destroyed.
+		bool read_version(Version *v, const DBHeader& hdr, bool lazy, std::string *errtext) ATTRIBUTE_NONNULL((2));
 		bool write_version(const Version *v, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
 
-		bool read_depend(Depend *dep, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool read_depend(Depend *dep, const DBHeader& hdr, bool lazy, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		/// Decode dependencies stored at offset; the file position is kept
+		bool read_depend_lazy(const Depend& dep, const DBHeader& hdr, eix::OffsetType offset, std::string *errtext);
+		bool read_depend_words(const Depend& dep, const DBHeader& hdr, std::string *errtext);
 		bool write_depend(const Depend& dep, const DBHeader& hdr, std::string *errtext);
 
 		bool read_category_header(std::string *name, eix::Treesize *h, std::string *errtext) ATTRIBUTE_NONNULL((2, 3));
@@ -143,8 +232,12 @@ class Database : public File {
 		bool write_hash(const StringHash& hash, std::string *errtext);
 		bool read_hash(StringHash *hash, std::string *errtext) ATTRIBUTE_NONNULL((2));
 
+		bool write_index_table(const DBIndex::CategoryEntry& cat, std::string *errtext);
+		bool read_index_table(DBIndex::CategoryEntry *cat, std::string *errtext) ATTRIBUTE_NONNULL((2));
+		bool write_index(DBIndex *index, std::string *errtext) ATTRIBUTE_NONNULL((2));
+
 	public:
-		Database() : counting(false), counter(0) {
+		Database() : buffer(NULLPTR) {
 		}
 
 		static void prep_header_hashs(DBHeader *hdr, const PackageTree& tree) ATTRIBUTE_NONNULL_;
@@ -154,9 +247,50 @@ class Database : public File {
 
 		bool write_packagetree(const PackageTree& pkg, const DBHeader& hdr, std::string *errtext);
 		bool read_packagetree(PackageTree *tree, const DBHeader& hdr, PortageSettings *ps, std::string *errtext) ATTRIBUTE_NONNULL((2, 4));
+
+		/// Read the category table of the index; the package tables are read on demand
+		bool read_index(DBIndex *index, const DBHeader& hdr, std::string *errtext) ATTRIBUTE_NONNULL((2));
 };
 
 template<typename m_Tp> bool Database::read_num(m_Tp *ret, std::string *errtext) {
+	if(likely(map_begin != NULLPTR)) {
+		// Decode directly from the current window
+		const eix::UChar *p(reinterpret_cast<const eix::UChar *>(map_curr));
+		const eix::UChar *end(reinterpret_cast<const eix::UChar *>(map_end));
+		if(likely(p != end)) {
+			eix::UChar c(*(p++));
+			// The one-byte case is exceptional w.r.t. to leading 0:
+			if(likely(c != MAGICNUMCHAR)) {
+				*ret = m_Tp(c);
+				map_curr = reinterpret_cast<const char *>(p);
+				return true;
+			}
+			unsigned int toget(1);
+			while(likely(p != end)) {
+				if((c = *(p++)) == MAGICNUMCHAR) {
+					++toget;
+					continue;
+				}
+				m_Tp r;
+				if(c != 0) {
+					r = static_cast<m_Tp>(c);
+				} else {  // leading 0 after MAGICNUMCHAR:
+					r = static_cast<m_Tp>(MAGICNUMCHAR);
+					--toget;
+				}
+				if(unlikely(static_cast<size_t>(end - p) < toget)) {
+					break;
+				}
+				for(; toget != 0; --toget) {
+					r = (r << 8) | static_cast<m_Tp>(*(p++));
+				}
+				*ret = r;
+				map_curr = reinterpret_cast<const char *>(p);
+				return true;
+			}
+		}
+		// The number exceeds the current block (or the file): use getch()
+	}
 	int ch(getch());
 	if(likely(ch != EOF)) {
 		eix::UChar c = static_cast<eix::UChar>(ch);
@@ -201,20 +335,12 @@ GCC_DIAG_OFF(sign-conversion)
 GCC_DIAG_ON(sign-conversion)
 	// Test the most common case explicitly to speed up:
 	if(t == static_cast<m_Tp>(c)) {
-		if(counting) {
-			if(unlikely(c == MAGICNUMCHAR)) {
-				counter += 2;
-			} else {
-				++counter;
-			}
-			return true;
-		}
-		if(likely(putch(c))) {
+		if(likely(put(c))) {
 			if(likely(c != MAGICNUMCHAR)) {
 				return true;
 			}
 			// write leading 0 as flag:
-			if(likely(putch(0))) {
+			if(likely(put(0))) {
 				return true;
 			}
 		}
@@ -229,40 +355,33 @@ GCC_DIAG_ON(sign-conversion)
 			++count;
 		} while((t & mask) != t);
 		// We have count > 0 here
-		if(counting) {
-GCC_DIAG_OFF(sign-conversion)
-			eix::UChar d((t >> (8*count)) & 0xFFU);
-			counter += ((unlikely(d == MAGICNUMCHAR)) ? 2 : 1) + (2 * count);
-GCC_DIAG_ON(sign-conversion)
-			return true;
-		}
 		for(unsigned int r(count); ;) {
-			if(unlikely(!putch(MAGICNUMCHAR))) {
+			if(unlikely(!put(MAGICNUMCHAR))) {
 				break;
 			}
 			if(--r == 0) {
 GCC_DIAG_OFF(sign-conversion)
 				eix::UChar d((t >> (8*count)) & 0xFFU);
 GCC_DIAG_ON(sign-conversion)
-				if(unlikely(!putch(d))) {
+				if(unlikely(!put(d))) {
 					break;
 				}
 				if(unlikely(d == MAGICNUMCHAR)) {
 					// write leading 0 as flag:
-					if(unlikely(!putch(0))) {
+					if(unlikely(!put(0))) {
 						break;
 					}
 				}
 				// neither rely on (t>>0)==t nor use count-- when count==0:
 				while(--count != 0) {
 GCC_DIAG_OFF(sign-conversion)
-					if(unlikely(!putch((t >> (8*count)) & 0xFFU))) {
+					if(unlikely(!put((t >> (8*count)) & 0xFFU))) {
 GCC_DIAG_ON(sign-conversion)
 						break;
 					}
 				}
 				if(likely(count == 0)) {
-					if(likely(putch(c))) {
+					if(likely(put(c))) {
 						return true;
 					}
 				}
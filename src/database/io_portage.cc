@@ -7,14 +7,16 @@
 
 #include <config.h>
 
+#include <algorithm>
 #include <string>
 
 #include "database/header.h"
+#include "database/index.h"
 #include "database/io.h"
 #include "database/package_reader.h"
-#include "eixTk/auto_list.h"
 #include "eixTk/diagnostics.h"
 #include "eixTk/eixint.h"
+#include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
 #include "eixTk/stringutils.h"
@@ -28,18 +30,20 @@
 #include "portage/packagetree.h"
 #include "portage/version.h"
 
+using std::sort;
 using std::string;
 
-#define WRITE_COUNTER(f) do { \
-	eix::OffsetType counter_save(counter); \
-	counter = 0; \
-	bool counting_save(counting); \
-	counting = true; \
-	f; \
-	counting = counting_save; \
-	eix::OffsetType counter_diff(counter); \
-	counter = counter_save; \
-	if(unlikely(!write_num(counter_diff, errtext))) { \
+/// Write the output of f into a buffer and then write its length and content.
+/// This way, each object is serialized only once.
+#define WRITE_BUFFERED(f) do { \
+	string *buffer_save(buffer); \
+	string buffered; \
+	buffer = &buffered; \
+	bool buffer_ok(f); \
+	buffer = buffer_save; \
+	if(unlikely(!(buffer_ok && \
+		likely(write_num(buffered.size(), errtext)) && \
+		likely(write_string_plain(buffered, errtext))))) { \
 		return false; \
 	} \
 } while(0)
@@ -51,36 +55,35 @@ bool Database::read_Part(BasicPart *b, string *errtext) {
 	}
 	BasicPart::PartType type(BasicPart::PartType(len % BasicPart::max_type));
 	len /= BasicPart::max_type;
-	if(len != 0) {
-		eix::auto_list<char> buf(new char[len + 1]);
-		buf.get()[len] = 0;
-		if(unlikely(!read_string_plain(buf.get(), len, errtext))) {
-			return false;
-		}
-		*b = BasicPart(type, string(buf.get()));
+	b->parttype = type;
+	if(likely(read_assign(&(b->partcontent), len))) {
 		return true;
 	}
-	*b = BasicPart(type);
-	return true;
+	readError(errtext);
+	return false;
 }
 
-bool Database::read_iuse(const StringHash& hash, IUseSet *iuse, string *errtext) {
+bool Database::read_iuse(const StringHash& hash, IUseSet *iuse, bool lazy, string *errtext) {
 	iuse->clear();
 	eix::UNumber e;
 	if(unlikely(!read_num(&e, errtext))) {
 		return false;
 	}
 	for(; e; --e) {
-		string s;
-		if(unlikely(!read_hash_string(hash, &s, errtext))) {
+		StringHash::size_type i;
+		if(unlikely(!read_num(&i, errtext))) {
 			return false;
 		}
-		iuse->insert_fast(s);
+		if(lazy) {
+			iuse->insert_lazy(&(hash[i]));
+		} else {
+			iuse->insert_fast(hash[i]);
+		}
 	}
 	return true;
 }
 
-bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
+bool Database::read_version(Version *v, const DBHeader& hdr, bool lazy, string *errtext) {
 	// read masking
 	MaskFlags::MaskType mask;
 	if(unlikely(!read_num(&mask, errtext))) {
@@ -103,11 +106,10 @@ bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
 		return false;
 	}
 	for(; likely(i != 0); --i) {
-		BasicPart b;
-		if(unlikely(!read_Part(&b, errtext))) {
+		v->m_parts.push_back(BasicPart());
+		if(unlikely(!read_Part(&(v->m_parts.back()), errtext))) {
 			return false;
 		}
-		v->m_parts.push_back(b);
 	}
 
 	string fullslot;
@@ -122,12 +124,12 @@ bool Database::read_version(Version *v, const DBHeader& hdr, string *errtext) {
 	v->reponame = overlay.label;
 	v->priority = overlay.priority;
 
-	if(unlikely(!read_iuse(hdr.iuse_hash, &(v->iuse), errtext))) {
+	if(unlikely(!read_iuse(hdr.iuse_hash, &(v->iuse), lazy, errtext))) {
 		return false;
 	}
 
 	if(hdr.use_depend) {
-		if(unlikely(!read_depend(&(v->depend), hdr, errtext))) {
+		if(unlikely(!read_depend(&(v->depend), hdr, lazy, errtext))) {
 			return false;
 		}
 	}
@@ -188,47 +190,61 @@ bool Database::write_version(const Version *v, const DBHeader& hdr, string *errt
 		return false;
 	}
 	if(hdr.use_depend) {
-		WRITE_COUNTER(write_depend(v->depend, hdr, NULLPTR));
-		if(unlikely(!write_depend(v->depend, hdr, errtext))) {
-			return false;
-		}
+		WRITE_BUFFERED(write_depend(v->depend, hdr, errtext));
 	}
 	return true;
 }
 
-bool Database::read_depend(Depend *dep, const DBHeader& hdr, string *errtext) {
+bool Database::read_depend(Depend *dep, const DBHeader& hdr, bool lazy, string *errtext) {
 	string::size_type len;
 	if(unlikely(!read_num(&len, errtext))) {
 		return false;
 	}
+	if(Depend::use_depend && !lazy) {
+		return read_depend_words(*dep, hdr, errtext);
+	}
+	dep->clear();
 	if(Depend::use_depend) {
-		if(unlikely(!read_hash_words(hdr.depend_hash, &(dep->m_depend), errtext))) {
-			return false;
-		}
-		if(unlikely(!read_hash_words(hdr.depend_hash, &(dep->m_rdepend), errtext))) {
-			return false;
-		}
-		if(unlikely(!read_hash_words(hdr.depend_hash, &(dep->m_pdepend), errtext))) {
-			return false;
-		}
-		if(hdr.version == 31) {
-			dep->m_hdepend.clear();
-		} else if(unlikely(!read_hash_words(hdr.depend_hash, &(dep->m_hdepend), errtext))) {
-			return false;
-		}
-		dep->obsolete = (hdr.version <= 32);
-	} else {
-		dep->clear();
+		dep->m_lazy_db = this;
+		dep->m_lazy_offset = tell();
+		dep->m_lazy_header = &hdr;
+	}
 GCC_DIAG_OFF(sign-conversion)
-		if(unlikely(!seekrel(len, errtext))) {
-			return false;
-		}
+	if(unlikely(!seekrel(len, errtext))) {
+		return false;
+	}
 GCC_DIAG_ON(sign-conversion)
+	return true;
+}
+
+bool Database::read_depend_lazy(const Depend& dep, const DBHeader& hdr, eix::OffsetType offset, string *errtext) {
+	eix::OffsetType curr(tell());
+	return (likely(seekabs(offset, errtext)) &&
+		likely(read_depend_words(dep, hdr, errtext)) &&
+		likely(seekabs(curr, errtext)));
+}
+
+bool Database::read_depend_words(const Depend& dep, const DBHeader& hdr, string *errtext) {
+	if(unlikely(!read_hash_words(hdr.depend_hash, &(dep.m_depend), errtext))) {
+		return false;
+	}
+	if(unlikely(!read_hash_words(hdr.depend_hash, &(dep.m_rdepend), errtext))) {
+		return false;
+	}
+	if(unlikely(!read_hash_words(hdr.depend_hash, &(dep.m_pdepend), errtext))) {
+		return false;
+	}
+	if(hdr.version == 31) {
+		dep.m_hdepend.clear();
+	} else if(unlikely(!read_hash_words(hdr.depend_hash, &(dep.m_hdepend), errtext))) {
+		return false;
 	}
+	dep.obsolete = (hdr.version <= 32);
 	return true;
 }
 
 bool Database::write_depend(const Depend& dep, const DBHeader& hdr, string *errtext) {
+	dep.load();
 	return (likely(write_hash_words(hdr.depend_hash, dep.m_depend, errtext)) &&
 		likely(write_hash_words(hdr.depend_hash, dep.m_rdepend, errtext)) &&
 		likely(write_hash_words(hdr.depend_hash, dep.m_pdepend, errtext)) &&
@@ -273,8 +289,8 @@ bool Database::write_package_pure(const Package& pkg, const DBHeader& hdr, strin
 }
 
 bool Database::write_package(const Package& pkg, const DBHeader& hdr, string *errtext) {
-	WRITE_COUNTER(write_package_pure(pkg, hdr, NULLPTR));
-	return write_package_pure(pkg, hdr, errtext);
+	WRITE_BUFFERED(write_package_pure(pkg, hdr, errtext));
+	return true;
 }
 
 bool Database::write_hash(const StringHash& hash, string *errtext) {
@@ -310,6 +326,7 @@ void Database::prep_header_hashs(DBHeader *hdr, const PackageTree& tree) {
 				hdr->slot_hash.hash_string(v->get_shortfullslot());
 				if(use_dep) {
 					const Depend& dep(v->depend);
+					dep.load();
 					hdr->depend_hash.hash_words(dep.m_depend);
 					hdr->depend_hash.hash_words(dep.m_rdepend);
 					hdr->depend_hash.hash_words(dep.m_pdepend);
@@ -377,31 +394,140 @@ bool Database::write_header(const DBHeader& hdr, string *errtext) {
 		if(unlikely(!write_num(1, errtext))) {
 			return false;
 		}
-		WRITE_COUNTER(write_hash(hdr.depend_hash, NULLPTR));
-		return write_hash(hdr.depend_hash, errtext);
+		WRITE_BUFFERED(write_hash(hdr.depend_hash, errtext));
+		return true;
 	} else {
 		return write_num(0, errtext);
 	}
 }
 
 bool Database::write_packagetree(const PackageTree& tree, const DBHeader& hdr, string *errtext) {
+	DBIndex index;
 	for(PackageTree::const_iterator c(tree.begin()); likely(c != tree.end()); ++c) {
 		Category *ci(c->second);
+		index.categories.push_back(DBIndex::CategoryEntry(c->first, tell()));
+		DBIndex::PackageTable& table(index.categories.back().packages);
 		// Write category-header followed by a list of the packages.
 		if(unlikely(!write_category_header(c->first, eix::Treesize(ci->size()), errtext))) {
 			return false;
 		}
 
 		for(Category::iterator p(ci->begin()); likely(p != ci->end()); ++p) {
+			table.push_back(DBIndex::PackageEntry(p->name, tell()));
 			// write package to fp
 			if(unlikely(!write_package(**p, hdr, errtext))) {
 				return false;
 			}
 		}
 	}
+	return write_index(&index, errtext);
+}
+
+bool Database::write_index_table(const DBIndex::CategoryEntry& cat, string *errtext) {
+	for(DBIndex::PackageTable::const_iterator it(cat.packages.begin());
+		likely(it != cat.packages.end()); ++it) {
+		if(unlikely(!write_string(it->name, errtext))) {
+			return false;
+		}
+		if(unlikely(!write_num(it->offset - cat.offset, errtext))) {
+			return false;
+		}
+	}
 	return true;
 }
 
+bool Database::write_index(DBIndex *index, string *errtext) {
+	eix::OffsetType start(tell());
+	if(unlikely(!write_num(index->categories.size(), errtext))) {
+		return false;
+	}
+	for(DBIndex::CategoryTable::iterator it(index->categories.begin());
+		likely(it != index->categories.end()); ++it) {
+		sort(it->packages.begin(), it->packages.end());
+		if(unlikely(!write_string(it->name, errtext))) {
+			return false;
+		}
+		if(unlikely(!write_num(it->offset, errtext))) {
+			return false;
+		}
+		if(unlikely(!write_num(it->packages.size(), errtext))) {
+			return false;
+		}
+		WRITE_BUFFERED(write_index_table(*it, errtext));
+	}
+	// The file ends with the offset of the index and the length of that number
+	eix::OffsetType trailer(tell());
+	if(unlikely(!write_num(start, errtext))) {
+		return false;
+	}
+	return writeUChar(eix::UChar(tell() - trailer), errtext);
+}
+
+bool Database::read_index(DBIndex *index, const DBHeader& hdr, string *errtext) {
+	index->categories.clear();
+	if(hdr.version < 35) {
+		if(errtext != NULLPTR) {
+			*errtext = _("database has no index");
+		}
+		return false;
+	}
+	eix::OffsetType save(tell());
+	eix::UChar len;
+	eix::OffsetType start;
+	if(unlikely(!(likely(seekend(-1, errtext)) &&
+		likely(readUChar(&len, errtext)) &&
+		likely(seekend(-1 - eix::OffsetType(len), errtext)) &&
+		likely(read_num(&start, errtext)) &&
+		likely(seekabs(start, errtext))))) {
+		return false;
+	}
+	eix::Catsize i;
+	if(unlikely(!read_num(&i, errtext))) {
+		return false;
+	}
+	for(; likely(i != 0); --i) {
+		string name;
+		eix::OffsetType offset;
+		if(unlikely(!(likely(read_string(&name, errtext)) &&
+			likely(read_num(&offset, errtext))))) {
+			return false;
+		}
+		index->categories.push_back(DBIndex::CategoryEntry(name, offset));
+		DBIndex::CategoryEntry& cat(index->categories.back());
+		if(unlikely(!(likely(read_num(&(cat.size), errtext)) &&
+			likely(read_num(&offset, errtext))))) {
+			return false;
+		}
+		cat.table = tell();
+		cat.loaded = false;
+		if(unlikely(!seekrel(offset, errtext))) {
+			return false;
+		}
+	}
+	index->m_db = this;
+	return seekabs(save, errtext);
+}
+
+bool Database::read_index_table(DBIndex::CategoryEntry *cat, string *errtext) {
+	eix::OffsetType save(tell());
+	if(unlikely(!seekabs(cat->table, errtext))) {
+		return false;
+	}
+	DBIndex::PackageTable& table(cat->packages);
+	table.clear();
+	table.reserve(cat->size);
+	for(eix::Treesize i(cat->size); likely(i != 0); --i) {
+		string name;
+		eix::OffsetType offset;
+		if(unlikely(!(likely(read_string(&name, errtext)) &&
+			likely(read_num(&offset, errtext))))) {
+			return false;
+		}
+		table.push_back(DBIndex::PackageEntry(name, cat->offset + offset));
+	}
+	return seekabs(save, errtext);
+}
+
 bool Database::read_packagetree(PackageTree *tree, const DBHeader& hdr, PortageSettings *ps, string *errtext) {
 	PackageReader reader(this, hdr, ps);
 	while(reader.nextCategory()) {
@@ -64,7 +64,7 @@ bool PackageReader::read(Attributes need) {
 				}
 				for(; likely(i != 0); --i) {
 					Version *v(new Version());
-					if(unlikely(!m_db->read_version(v, *header, &m_errtext))) {
+					if(unlikely(!m_db->read_version(v, *header, m_lazy, &m_errtext))) {
 						m_error = true;
 						return false;
 					}
@@ -109,7 +109,17 @@ Package *PackageReader::release() {
 }
 
 bool PackageReader::next() {
-	if(unlikely(m_cat_size-- == 0)) {
+	if(unlikely(m_index != NULLPTR)) {
+		if(m_hit == m_hits.end()) {
+			return false;
+		}
+		eix::OffsetType offset(*(m_hit++));
+		if(unlikely(!m_db->seekabs(offset, &m_errtext))) {
+			m_error = true;
+			return false;
+		}
+		m_cat_name = m_index->categoryAt(offset);
+	} else if(unlikely(m_cat_size-- == 0)) {
 		if(unlikely(m_frames-- == 0)) {
 			return false;
 		}
@@ -120,6 +130,7 @@ bool PackageReader::next() {
 		return next();
 	}
 
+	m_offset = m_db->tell();
 	eix::OffsetType len;
 	if(unlikely(!m_db->read_num(&len, &m_errtext))) {
 		m_error = true;
@@ -134,6 +145,16 @@ bool PackageReader::next() {
 	return true;
 }
 
+bool PackageReader::useCategories(eix::OffsetType offset, eix::Catsize count) {
+	m_frames = count;
+	m_cat_size = 0;
+	if(likely(m_db->seekabs(offset, &m_errtext))) {
+		return true;
+	}
+	m_error = true;
+	return false;
+}
+
 bool PackageReader::nextCategory() {
 	if(unlikely(m_frames-- == 0)) {
 		return false;
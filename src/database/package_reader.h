@@ -16,6 +16,7 @@
 #include <string>
 
 #include "database/header.h"
+#include "database/index.h"
 #include "eixTk/eixint.h"
 #include "eixTk/null.h"
 
@@ -36,11 +37,11 @@ class PackageReader {
 		/** Initialize with file-stream and number of packages.
 		    @arg ps is used to define the local package sets while version reading */
 		PackageReader(Database *db, const DBHeader& hdr, PortageSettings *ps)
-			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(ps), m_error(false) {
+			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(ps), m_index(NULLPTR), m_lazy(false), m_error(false) {
 		}
 
 		PackageReader(Database *db, const DBHeader& hdr)
-			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(NULLPTR), m_error(false) {
+			: m_db(db), m_frames(hdr.size), m_cat_size(0), m_pkg(NULLPTR), header(&hdr), m_portagesettings(NULLPTR), m_index(NULLPTR), m_lazy(false), m_error(false) {
 		}
 
 		~PackageReader();
@@ -70,6 +71,31 @@ class PackageReader {
 		// Read the package-header
 		bool next();
 
+		/// Let next() only visit count categories, starting at offset.
+		// nextCategory() and nextPackage() must not be used afterwards.
+		bool useCategories(eix::OffsetType offset, eix::Catsize count);
+
+		/// Return the offset of the package read by next()
+		eix::OffsetType offset() const {
+			return m_offset;
+		}
+
+		/// Let next() only visit the packages at the offsets in hits.
+		// The index must be valid while reading.
+		// nextCategory() and nextPackage() must not be used afterwards.
+		void useIndex(const DBIndex *index, const DBIndex::Hits& hits) ATTRIBUTE_NONNULL((2)) {
+			m_index = index;
+			m_hits = hits;
+			m_hit = m_hits.begin();
+		}
+
+		/// Decode IUSE and dependencies of versions only when they are used.
+		// The database and header must then be kept until the packages
+		// read (also those returned by release()) are destroyed.
+		void useLazy() {
+			m_lazy = true;
+		}
+
 		/// Go into the next (or first) category part.
 		// @return false if there are none more.
 		bool nextCategory();
@@ -94,6 +120,7 @@ class PackageReader {
 		eix::Treesize     m_cat_size;
 		std::string       m_cat_name;
 
+		eix::OffsetType   m_offset;
 		off_t             m_next;
 		Attributes        m_have;
 		Package          *m_pkg;
@@ -101,6 +128,12 @@ class PackageReader {
 		const DBHeader   *header;
 		PortageSettings  *m_portagesettings;
 
+		const DBIndex    *m_index;
+		DBIndex::Hits     m_hits;
+		DBIndex::Hits::const_iterator m_hit;
+
+		bool m_lazy;
+
 		std::string m_errtext;
 		bool m_error;
 };
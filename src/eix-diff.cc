@@ -232,13 +232,11 @@ class DiffTrees {
 						changed_package(*old_pkg, *new_pkg);
 
 					// Remove the new package
-					delete *new_pkg;
-					new_cat->erase(new_pkg);
+					new_cat->delete_package(new_pkg);
 				}
 
 				// Remove the old packages
-				delete *old_pkg;
-				old_pkg = old_cat->erase(old_pkg);
+				old_pkg = old_cat->delete_package(old_pkg);
 			}
 		}
 };
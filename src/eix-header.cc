@@ -51,7 +51,7 @@ bool print_overlay_data(string *result, const DBHeader& header, const char *over
 
 static void print_help() {
 	cout << eix::format(_(
-"Usage: %s [-q] [-f FILE] [-s SEP] [-c] [-l OV] [-p OV] [-o OV] ...\n"
+"Usage: %s [-q] [-f FILE] [-s SEP] [-c] [-z] [-l OV] [-p OV] [-o OV] ...\n"
 "Check whether eix database FILE has current format, and print label, path,\n"
 "or both of specified overlay OV in FILE, appending SEP to each data.\n"
 "All options can be used repeatedly: FILE and SEP are active until modified.\n"
@@ -65,6 +65,7 @@ static void print_help() {
 "SEP defaults to the null character (to be distinguished from the empty string).\n"
 "-c can be used to check only whether FILE has current format without producing\n"
 "any output.\n"
+"-z prints the compression of FILE (none or zlib), appending SEP.\n"
 "After option -q no further output is made, usually.\n"
 "So specify -q first if you want no output at all.\n"
 "The special option -h outputs this help text and quits.\n"
@@ -108,7 +109,7 @@ int run_eix_header(int argc, char *argv[]) {
 		}
 		size_t curr(1);
 		char opt(argv[0][curr++]);
-		while(unlikely(strchr("cqhH?", opt) != NULLPTR)) {
+		while(unlikely(strchr("cqzhH?", opt) != NULLPTR)) {
 			switch(opt) {
 				case '?':
 				case 'H':
@@ -204,6 +205,20 @@ int overlay_loop(string *result, const OverlayOptionList& options) {
 				ret = EXIT_FAILURE;
 			}
 		}
+		if(unlikely(it->opt == 'z')) {
+			if(likely(name != NULLPTR)) {
+				if(likely(verbose)) {
+					result->append(File::compression_name(db.compression()));
+					result->append(separator);
+				}
+			} else {
+				if(likely(verbose)) {
+					result->append(separator);
+				}
+				ret = EXIT_FAILURE;
+			}
+			continue;
+		}
 		if(unlikely(mode == PRINT_OVERLAY_NONE)) {
 			continue;
 		}
@@ -11,19 +11,29 @@
 
 #include <fnmatch.h>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include <iostream>
 #include <list>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "cache/base.h"
 #include "cache/cachetable.h"
 #include "database/header.h"
+#include "database/index.h"
 #include "database/io.h"
+#include "database/package_reader.h"
 #include "eixTk/argsreader.h"
+#include "eixTk/eixint.h"
 #include "eixTk/filenames.h"
 #include "eixTk/formated.h"
 #include "eixTk/i18n.h"
@@ -38,11 +48,14 @@
 #include "eixrc/eixrc.h"
 #include "eixrc/global.h"
 #include "main/main.h"
+#include "portage/basicversion.h"
 #include "portage/conf/portagesettings.h"
 #include "portage/depend.h"
 #include "portage/extendedversion.h"
 #include "portage/overlay.h"
+#include "portage/package.h"
 #include "portage/packagetree.h"
+#include "portage/version.h"
 #include "various/drop_permissions.h"
 
 using std::list;
@@ -105,8 +118,54 @@ typedef vector<Pathname> PathVec;
 typedef vector<Override> Overrides;
 typedef vector<RepoName> RepoNames;
 
+/// The result of reading an overlay; also used as exit status of the jobs
+enum ReadResult {
+	READ_FINISHED = 0,
+	READ_ABORTED,
+	READ_EMPTY,
+	READ_FAILED
+};
+
+/// A part of an overlay read by a separate process into a temporary database file
+class Fragment {
+	public:
+		std::string file;
+		pid_t pid;
+		ReadResult result;
+
+		/// The process sends the error text through this pipe
+		int error_fd;
+		std::string errtext;
+
+		Fragment() : pid(-1), result(READ_FAILED), error_fd(-1) {
+		}
+};
+
+/// The parts of one overlay; their categories are disjoint
+typedef vector<Fragment> Fragments;
+
+/// The fragments of all overlays
+typedef vector<Fragments> CacheFragments;
+
+/// The fingerprints of all caches for each category
+typedef std::map<string, string> Fingerprints;
+
 static void print_help();
-static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) ATTRIBUTE_NONNULL_;
+static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, unsigned int jobs, bool incremental, File::Compression compression, string *errtext) ATTRIBUTE_NONNULL_;
+static ReadResult read_cache(BasicCache *cache, PackageTree *package_tree, const WordSet& skip) ATTRIBUTE_NONNULL_;
+static void add_package(Category *cat, const Package& p) ATTRIBUTE_NONNULL_;
+static bool write_fragment(const char *file, const PackageTree& package_tree, const DBHeader& dbheader, string *errtext) ATTRIBUTE_NONNULL_;
+static bool merge_fragment(PackageTree *package_tree, const char *file, bool replace, string *errtext) ATTRIBUTE_NONNULL_;
+static void wait_fragment(CacheFragments *fragments) ATTRIBUTE_NONNULL_;
+static ReadResult fragments_result(const Fragments& fragments) ATTRIBUTE_PURE;
+static void print_fragment_errors(const Fragments& fragments);
+static bool start_fragment(Fragment *fragment, BasicCache *cache, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int part, unsigned int parts) ATTRIBUTE_NONNULL_;
+static void start_fragments(CacheFragments *fragments, CacheTable *cache_table, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int jobs) ATTRIBUTE_NONNULL_;
+static void split_fragments(CacheFragments *fragments, CacheFragments::size_type i, BasicCache *cache, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int jobs) ATTRIBUTE_NONNULL_;
+static string fingerprint_setup(const CacheTable& cache_table, const char *dbfile) ATTRIBUTE_NONNULL_;
+static bool calc_fingerprints(Fingerprints *fingerprints, CacheTable *cache_table, const PackageTree& package_tree) ATTRIBUTE_NONNULL_;
+static void write_fingerprints(const char *file, const string& setup, const Fingerprints& fingerprints) ATTRIBUTE_NONNULL_;
+static eix::Treesize reuse_categories(PackageTree *package_tree, WordSet *reused, const char *file, const string& setup, const Fingerprints& fingerprints, const char *dbfile) ATTRIBUTE_NONNULL_;
 static void error_callback(const string& str);
 static void add_pathnames(PathVec *add_list, const WordVec& to_add, bool must_resolve) ATTRIBUTE_NONNULL_;
 static void add_override(Overrides *override_list, EixRc *eixrc, const char *s) ATTRIBUTE_NONNULL_;
@@ -132,6 +191,8 @@ static void print_help() {
 "\n"
 " -q, --quiet             produce no output\n"
 "\n"
+" -j  --jobs              number of overlays read in parallel\n"
+"\n"
 " -o  --output            output to another file than %s\n"
 "                         In addition, all permission checks are omitted.\n"
 " -x  --exclude-overlay   exclude matching overlays from the update-process.\n"
@@ -177,6 +238,7 @@ static MethodArgs *method_args;
 static RepoArgs *repo_args;
 
 static const char *outputname = NULLPTR;
+static const char *jobs_arg = NULLPTR;
 static const char *var_to_print = NULLPTR;
 
 /** Arguments and options. */
@@ -204,6 +266,7 @@ EixUpdateOptionList::EixUpdateOptionList() {
 	push_back(Option("override-method", 'm',    Option::PAIRLIST,   method_args));
 	push_back(Option("repo-name",      'r',     Option::PAIRLIST,   repo_args));
 	push_back(Option("output",         'o',     Option::STRING,     &outputname));
+	push_back(Option("jobs",           'j',     Option::STRING,     &jobs_arg));
 }
 
 static PercentStatus *reading_percent_status;
@@ -537,12 +600,27 @@ int run_eix_update(int argc, char *argv[]) {
 		}
 	}
 
+	unsigned int jobs((jobs_arg != NULLPTR) ?
+		my_atoi(jobs_arg) : eixrc.getInteger("UPDATE_JOBS"));
+	if(jobs == 0) {
+		long cpus(sysconf(_SC_NPROCESSORS_ONLN));
+		jobs = ((cpus > 0) ? static_cast<unsigned int>(cpus) : 1);
+	}
+
+	File::Compression compression;
+	if(unlikely(!File::compression_from_name(&compression, eixrc["DATABASE_COMPRESSION"]))) {
+		cerr << eix::format(_("%s=%s is not supported: the database is written uncompressed"))
+			% "DATABASE_COMPRESSION" % eixrc["DATABASE_COMPRESSION"] << endl;
+		compression = File::COMPRESS_NONE;
+	}
+
 	INFO(eix::format(_("Building database (%s) ..\n")) % outputfile);
 
 	/* Update the database from scratch */
 	string errtext;
 	if(unlikely(!update(outputfile.c_str(), &table, &portage_settings, override_umask,
-			repo_names, excluded_overlays, &statusline, &errtext))) {
+			repo_names, excluded_overlays, &statusline, jobs,
+			eixrc.getBool("UPDATE_INCREMENTAL"), compression, &errtext))) {
 		cerr << errtext << endl;
 		statusline.failure();
 		return EXIT_FAILURE;
@@ -557,7 +635,513 @@ static void error_callback(const string& str) {
 	reading_percent_status->interprint_end();
 }
 
-static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, string *errtext) {
+static ReadResult read_cache(BasicCache *cache, PackageTree *package_tree, const WordSet& skip) {
+	ReadResult result;
+	reading_percent_status = new PercentStatus;
+	if(cache->can_read_multiple_categories()) {
+		reading_percent_status->init(_("     Reading Packages .. "));
+		cache->setErrorCallback(error_callback);
+		result = (likely(cache->readCategories(package_tree)) ?
+			READ_FINISHED : READ_ABORTED);
+		reading_percent_status->finish((result == READ_FINISHED) ?
+			_("Finished") : _("ABORTED!"));
+	} else {
+		if(use_percentage) {
+			reading_percent_status->init(
+				_("     Reading category %s|%s (%s%%)"),
+				package_tree->size());
+		} else {
+			reading_percent_status->init(eix::format(
+				_("     Reading up to %s categories of packages .. ")) %
+				package_tree->size());
+		}
+
+		/* iterator through categories */
+		bool aborted(false);
+		bool is_empty(true);
+		for(PackageTree::const_iterator ci(package_tree->begin());
+			unlikely(ci != package_tree->end()); ++ci) {
+			if(skip.find(ci->first) != skip.end()) {
+				// the category was taken from the previous database
+				if(use_percentage) {
+					reading_percent_status->next();
+				}
+				is_empty = false;
+				continue;
+			}
+			if(!cache->readCategoryPrepare(ci->first.c_str())) {
+				if(use_percentage) {
+					reading_percent_status->next();
+				}
+			} else {
+				if(use_percentage) {
+					reading_percent_status->next(eix::format(_(": %s ..")) % ci->first);
+				}
+				is_empty = false;
+				if(!cache->readCategory(ci->second)) {
+					aborted = true;
+				}
+			}
+			cache->readCategoryFinalize();
+		}
+		result = (unlikely(is_empty) ? READ_EMPTY :
+			(unlikely(aborted) ? READ_ABORTED : READ_FINISHED));
+		string msg((result == READ_EMPTY) ? _("EMPTY!") :
+			((result == READ_ABORTED) ? _("ABORTED!") :
+				_("Finished")));
+		if(use_percentage) {
+			msg.insert(string::size_type(0), 1, ' ');
+		}
+		reading_percent_status->finish(msg);
+	}
+	delete reading_percent_status;
+	return result;
+}
+
+/**
+Add the versions of p (read from a database) to cat in the same way as the
+caches add the versions of an overlay. Masks are not copied.
+**/
+static void add_package(Category *cat, const Package& p) {
+	Package *pkg(cat->findPackage(p.name));
+	if(pkg == NULLPTR) {
+		pkg = cat->addPackage(p.category, p.name);
+	}
+	for(Package::const_iterator it(p.begin()); likely(it != p.end()); ++it) {
+		Version *version(new Version);
+		*static_cast<BasicVersion *>(version) = *static_cast<const BasicVersion *>(*it);
+		version->overlay_key = it->overlay_key;
+		version->set_full_keywords(it->get_full_keywords());
+		version->slotname = it->slotname;
+		version->subslotname = it->subslotname;
+		version->restrictFlags = it->restrictFlags;
+		version->propertiesFlags = it->propertiesFlags;
+		version->iuse = it->iuse;
+		version->depend = it->depend;
+		pkg->addVersion(version);
+		if(*(pkg->latest()) == *version) {
+			pkg->homepage = p.homepage;
+			pkg->licenses = p.licenses;
+			pkg->desc     = p.desc;
+		}
+	}
+}
+
+static bool write_fragment(const char *file, const PackageTree& package_tree, const DBHeader& dbheader, string *errtext) {
+	DBHeader header(dbheader);
+	Database::prep_header_hashs(&header, package_tree);
+	header.size = package_tree.countCategories();
+	Database db;
+	if(unlikely(!db.openwrite(file))) {
+		*errtext = eix::format(_("cannot write %s: %s")) % file % strerror(errno);
+		return false;
+	}
+	bool ok(likely(db.write_header(header, errtext)) &&
+		likely(db.write_packagetree(package_tree, header, errtext)));
+	// Keep the first error text
+	return (likely(db.closewrite(ok ? errtext : NULLPTR)) && ok);
+}
+
+/**
+Add the versions of a database written by write_fragment() to package_tree
+in the same way as the caches add the versions of an overlay.
+If replace is true, the categories of the database replace those of
+package_tree; this is used if the database contains also the packages
+of the previous overlays.
+**/
+static bool merge_fragment(PackageTree *package_tree, const char *file, bool replace, string *errtext) {
+	Database db;
+	if(unlikely(!db.openread(file))) {
+		*errtext = eix::format(_("cannot read %s: %s")) % file % strerror(errno);
+		return false;
+	}
+	DBHeader header;
+	if(unlikely(!db.read_header(&header, errtext))) {
+		return false;
+	}
+	PackageReader reader(&db, header);
+	const Category *replaced(NULLPTR);
+	for(; reader.next(); reader.skip()) {
+		if(unlikely(!reader.read())) {
+			break;
+		}
+		const Package *p(reader.get());
+		Category *cat(package_tree->find(p->category));
+		if(unlikely(cat == NULLPTR)) {
+			continue;
+		}
+		if(replace && (cat != replaced)) {
+			cat->delete_and_clear();
+			replaced = cat;
+		}
+		add_package(cat, *p);
+	}
+	const char *err_cstr(reader.get_errtext());
+	if(unlikely(err_cstr != NULLPTR)) {
+		*errtext = eix::format(_("error in file %s: %s")) % file % err_cstr;
+		return false;
+	}
+	return true;
+}
+
+/// Wait for one process started by start_fragments() and store its result
+static void wait_fragment(CacheFragments *fragments) {
+	int status;
+	pid_t pid(waitpid(-1, &status, 0));
+	if(unlikely(pid == -1)) {
+		return;
+	}
+	for(CacheFragments::iterator cf(fragments->begin()); likely(cf != fragments->end()); ++cf) {
+		for(Fragments::iterator it(cf->begin()); likely(it != cf->end()); ++it) {
+			if(it->pid != pid) {
+				continue;
+			}
+			it->pid = -1;
+			if(likely(WIFEXITED(status) && (WEXITSTATUS(status) < READ_FAILED))) {
+				it->result = static_cast<ReadResult>(WEXITSTATUS(status));
+			}
+			// The process has finished, so everything it sent can be read
+			char buf[512];
+			ssize_t r;
+			while(((r = read(it->error_fd, buf, sizeof(buf))) > 0) ||
+				((r < 0) && (errno == EINTR))) {
+				if(r > 0) {
+					it->errtext.append(buf, static_cast<size_t>(r));
+				}
+			}
+			close(it->error_fd);
+			it->error_fd = -1;
+			return;
+		}
+	}
+}
+
+/**
+Combine the results of the parts of an overlay.
+@return READ_FAILED if some part failed (or if there are no parts)
+**/
+static ReadResult fragments_result(const Fragments& fragments) {
+	if(fragments.empty()) {
+		return READ_FAILED;
+	}
+	ReadResult result(READ_EMPTY);
+	for(Fragments::const_iterator it(fragments.begin()); likely(it != fragments.end()); ++it) {
+		if(unlikely(it->result == READ_FAILED)) {
+			return READ_FAILED;
+		}
+		if(it->result == READ_ABORTED) {
+			result = READ_ABORTED;
+		} else if((it->result == READ_FINISHED) && (result == READ_EMPTY)) {
+			result = READ_FINISHED;
+		}
+	}
+	return result;
+}
+
+/// Print the errors which the processes of the fragments have sent
+static void print_fragment_errors(const Fragments& fragments) {
+	for(Fragments::const_iterator it(fragments.begin()); likely(it != fragments.end()); ++it) {
+		if(unlikely(!it->errtext.empty())) {
+			cerr << it->errtext << endl;
+		}
+	}
+}
+
+/**
+Start a process which reads every parts-th category of package_tree,
+starting with the part-th, with cache into a temporary database.
+@return false if the process could not be started
+**/
+static bool start_fragment(Fragment *fragment, BasicCache *cache, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int part, unsigned int parts) {
+	// A fragment of split_fragments() can replace a failed one
+	if(!fragment->file.empty()) {
+		unlink(fragment->file.c_str());
+	}
+	fragment->errtext.clear();
+	const char *tmpdir(getenv("TMPDIR"));
+	string name(((tmpdir != NULLPTR) && (*tmpdir != '\0')) ? tmpdir : "/tmp");
+	name.append("/eix-update.XXXXXXXX");
+	vector<char> temp(name.begin(), name.end());
+	temp.push_back('\0');
+	int fd(mkstemp(&(temp[0])));
+	if(unlikely(fd == -1)) {
+		return false;
+	}
+	close(fd);
+	fragment->file = &(temp[0]);
+	int pipefd[2];
+	if(unlikely(pipe(pipefd) != 0)) {
+		return false;
+	}
+	pid_t child(fork());
+	if(unlikely(child == -1)) {
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return false;
+	}
+	if(child == 0) {
+		close(pipefd[0]);
+		// The output of several processes would be garbled
+		if(freopen(DEV_NULL, "w", stdout) == NULLPTR) {
+			_exit(READ_FAILED);
+		}
+		// Only what is read here belongs into the fragment
+		unsigned int c(0);
+		for(PackageTree::iterator ci(package_tree->begin());
+			likely(ci != package_tree->end()); ++c) {
+			if(skip.find(ci->first) != skip.end()) {
+				ci->second->delete_and_clear();
+			} else if(c % parts != part) {
+				delete ci->second;
+				package_tree->erase(ci++);
+				continue;
+			}
+			++ci;
+		}
+		ReadResult result(read_cache(cache, package_tree, skip));
+		string errtext;
+		if(unlikely(!write_fragment(&(temp[0]), *package_tree, dbheader, &errtext))) {
+			result = READ_FAILED;
+			// The text is short enough to fit into the buffer of the pipe
+			if(unlikely(write(pipefd[1], errtext.c_str(), errtext.size()) < 0)) {
+				// The parent only misses the text then
+			}
+		}
+		_exit(result);
+	}
+	close(pipefd[1]);
+	fragment->error_fd = pipefd[0];
+	fragment->pid = child;
+	return true;
+}
+
+/**
+Read the overlays of cache_table with at most jobs processes, each writing
+into a temporary database. If there are more jobs than such overlays,
+the categories of an overlay are distributed to several processes.
+Caches whose result depends on previous overlays are left to the caller,
+as well as all overlays for which some process fails.
+**/
+static void start_fragments(CacheFragments *fragments, CacheTable *cache_table, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int jobs) {
+	unsigned int parallel(0);
+	for(CacheTable::iterator it(cache_table->begin());
+		likely(it != cache_table->end()); ++it) {
+		if(it->can_read_in_parallel()) {
+			++parallel;
+		}
+	}
+	if(parallel == 0) {
+		return;
+	}
+	unsigned int parts(jobs / parallel);
+	if(parts == 0) {
+		parts = 1;
+	} else if(parts > package_tree->size()) {
+		parts = package_tree->size();
+	}
+	fflush(stdout);
+	cerr.flush();
+	unsigned int running(0);
+	CacheFragments::size_type i(0);
+	for(CacheTable::iterator it(cache_table->begin());
+		likely(it != cache_table->end()); ++it, ++i) {
+		BasicCache *cache(*it);
+		if(!cache->can_read_in_parallel()) {
+			continue;
+		}
+		Fragments& cache_fragments((*fragments)[i]);
+		cache_fragments.resize(parts);
+		for(unsigned int part(0); part != parts; ++part) {
+			if(running == jobs) {
+				wait_fragment(fragments);
+				--running;
+			}
+			if(likely(start_fragment(&(cache_fragments[part]), cache, package_tree, dbheader, skip, part, parts))) {
+				++running;
+			}
+		}
+	}
+	for(; running != 0; --running) {
+		wait_fragment(fragments);
+	}
+}
+
+/**
+Read the categories of the i-th overlay with up to jobs processes.
+In contrast to start_fragments(), this must be called after the previous
+overlays have been read, and each process writes also their packages
+of its categories. Hence, the results must be merged with replace = true.
+**/
+static void split_fragments(CacheFragments *fragments, CacheFragments::size_type i, BasicCache *cache, PackageTree *package_tree, const DBHeader& dbheader, const WordSet& skip, unsigned int jobs) {
+	unsigned int parts(jobs);
+	if(parts > package_tree->size()) {
+		parts = package_tree->size();
+	}
+	fflush(stdout);
+	cerr.flush();
+	Fragments& cache_fragments((*fragments)[i]);
+	cache_fragments.resize(parts);
+	unsigned int running(0);
+	for(unsigned int part(0); part != parts; ++part) {
+		if(likely(start_fragment(&(cache_fragments[part]), cache, package_tree, dbheader, skip, part, parts))) {
+			++running;
+		}
+	}
+	for(; running != 0; --running) {
+		wait_fragment(fragments);
+	}
+}
+
+/**
+Describe everything which must not change for using the fingerprints:
+The previous database itself, and the caches and their order
+**/
+static string fingerprint_setup(const CacheTable& cache_table, const char *dbfile) {
+	struct stat st;
+	if(unlikely(stat(dbfile, &st) != 0)) {
+		return "";
+	}
+	string setup(eix::format("eix-fingerprints %s %s %s") %
+		st.st_size % st.st_mtime % (Depend::use_depend ? 1 : 0));
+	for(CacheTable::const_iterator it(cache_table.begin());
+		likely(it != cache_table.end()); ++it) {
+		setup.append(eix::format("\t%s %s %s") %
+			it->getKey() % it->getType() % it->getPathHumanReadable());
+	}
+	return setup;
+}
+
+/**
+Calculate the fingerprints of all categories for all caches.
+@return false if some cache cannot provide fingerprints
+**/
+static bool calc_fingerprints(Fingerprints *fingerprints, CacheTable *cache_table, const PackageTree& package_tree) {
+	for(CacheTable::iterator it(cache_table->begin());
+		likely(it != cache_table->end()); ++it) {
+		if(it->can_read_multiple_categories()) {
+			return false;
+		}
+	}
+	reading_percent_status = new PercentStatus;
+	reading_percent_status->init(_("Calculating fingerprints .. "));
+	bool success(true);
+	for(PackageTree::const_iterator ci(package_tree.begin());
+		likely(success && (ci != package_tree.end())); ++ci) {
+		string& fingerprint((*fingerprints)[ci->first]);
+		for(CacheTable::iterator it(cache_table->begin());
+			likely(it != cache_table->end()); ++it) {
+			BasicCache *cache(*it);
+			string fp("-");
+			if(cache->readCategoryPrepare(ci->first.c_str()) &&
+				unlikely(!cache->fingerprint(&fp))) {
+				success = false;
+			}
+			cache->readCategoryFinalize();
+			if(unlikely(!success)) {
+				break;
+			}
+			if(!fingerprint.empty()) {
+				fingerprint.append(1, ' ');
+			}
+			fingerprint.append(fp);
+		}
+	}
+	reading_percent_status->finish(success ? _("Finished") : _("unsupported"));
+	delete reading_percent_status;
+	if(unlikely(!success)) {
+		fingerprints->clear();
+	}
+	return success;
+}
+
+static void write_fingerprints(const char *file, const string& setup, const Fingerprints& fingerprints) {
+	FILE *fp(fopen(file, "w"));
+	if(unlikely(fp == NULLPTR)) {
+		cerr << eix::format(_("cannot write %s: %s")) % file % strerror(errno) << endl;
+		return;
+	}
+	fprintf(fp, "%s\n", setup.c_str());
+	for(Fingerprints::const_iterator it(fingerprints.begin());
+		likely(it != fingerprints.end()); ++it) {
+		fprintf(fp, "%s %s\n", it->first.c_str(), it->second.c_str());
+	}
+	if(unlikely(fclose(fp) != 0)) {
+		unlink(file);
+	}
+}
+
+/**
+Copy all categories whose fingerprints are unchanged since the previous run
+from the previous database into package_tree.
+@return number of reused packages
+**/
+static eix::Treesize reuse_categories(PackageTree *package_tree, WordSet *reused, const char *file, const string& setup, const Fingerprints& fingerprints, const char *dbfile) {
+	LineVec lines;
+	if((!pushback_lines(file, &lines, false, false, 1)) ||
+		lines.empty() || (lines[0] != setup)) {
+		return 0;
+	}
+	WordSet unchanged;
+	for(LineVec::const_iterator it(lines.begin() + 1); likely(it != lines.end()); ++it) {
+		string::size_type pos(it->find(' '));
+		if(unlikely(pos == string::npos)) {
+			continue;
+		}
+		string cat(*it, 0, pos);
+		Fingerprints::const_iterator fp(fingerprints.find(cat));
+		if((fp != fingerprints.end()) && (it->compare(pos + 1, string::npos, fp->second) == 0)) {
+			unchanged.insert(cat);
+		}
+	}
+	if(unchanged.empty()) {
+		return 0;
+	}
+
+	Database db;
+	DBHeader header;
+	DBIndex index;
+	if(unlikely(!(db.openread(dbfile) &&
+		db.read_header(&header, NULLPTR) &&
+		db.read_index(&index, header, NULLPTR)))) {
+		return 0;
+	}
+	eix::Treesize count(0);
+	bool success(true);
+	for(DBIndex::CategoryTable::const_iterator it(index.categories.begin());
+		likely(success && (it != index.categories.end())); ++it) {
+		if(unchanged.find(it->name) == unchanged.end()) {
+			continue;
+		}
+		Category *cat(package_tree->find(it->name));
+		if(unlikely(cat == NULLPTR)) {
+			continue;
+		}
+		PackageReader reader(&db, header);
+		success = reader.useCategories(it->offset, 1);
+		for(; likely(success && reader.next()); reader.skip()) {
+			if(unlikely(!reader.read())) {
+				break;
+			}
+			add_package(cat, *(reader.get()));
+			++count;
+		}
+		if(unlikely(reader.get_errtext() != NULLPTR)) {
+			success = false;
+		}
+		reused->insert(it->name);
+	}
+	if(unlikely(!success)) {
+		// Do not use partial data
+		for(WordSet::const_iterator it(reused->begin()); likely(it != reused->end()); ++it) {
+			package_tree->find(*it)->delete_and_clear();
+		}
+		reused->clear();
+		return 0;
+	}
+	return count;
+}
+
+static bool update(const char *outputfile, CacheTable *cache_table, PortageSettings *portage_settings, bool override_umask, const RepoNames& repo_names, const WordVec& exclude_labels, Statusline *statusline, unsigned int jobs, bool incremental, File::Compression compression, string *errtext) {
 	DBHeader dbheader;
 	WordVec categories;
 	portage_settings->pushback_categories(&categories);
@@ -596,9 +1180,31 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 		++it;
 	}
 
+	/* Take the categories which did not change from the previous database */
+	Fingerprints fingerprints;
+	WordSet reused;
+	string fingerprint_file(outputfile);
+	fingerprint_file.append(".fingerprints");
+	if(incremental && calc_fingerprints(&fingerprints, cache_table, package_tree)) {
+		eix::Treesize count(reuse_categories(&package_tree, &reused,
+			fingerprint_file.c_str(), fingerprint_setup(*cache_table, outputfile),
+			fingerprints, outputfile));
+		if(count != 0) {
+			INFO(eix::format(_("Reusing %s packages in %s unchanged categories ..\n"))
+				% count % reused.size());
+		}
+	}
+
+	/* Read the overlays independent of each other in advance */
+	CacheFragments fragments(cache_table->size());
+	if(jobs > 1) {
+		start_fragments(&fragments, cache_table, &package_tree, dbheader, reused, jobs);
+	}
+
 	/* Build database from scratch. */
+	CacheFragments::iterator cache_fragments(fragments.begin());
 	for(CacheTable::iterator it(cache_table->begin());
-		likely(it != cache_table->end()); ++it) {
+		likely(it != cache_table->end()); ++it, ++cache_fragments) {
 		BasicCache *cache(*it);
 		INFO(eix::format(_("[%s] %r %s (cache: %s)\n"))
 			% cache->getKey()
@@ -608,53 +1214,41 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 		statusline->print(eix::format(_("[%s] %s"))
 				% cache->getKey()
 				% cache->getOverlayName());
-		reading_percent_status = new PercentStatus;
-		if(cache->can_read_multiple_categories()) {
-			reading_percent_status->init(_("     Reading Packages .. "));
-			cache->setErrorCallback(error_callback);
-			reading_percent_status->finish(
-				likely(cache->readCategories(&package_tree)) ?
-				_("Finished") : _("ABORTED!"));
+		ReadResult result(fragments_result(*cache_fragments));
+		print_fragment_errors(*cache_fragments);
+		bool replace(false);
+		if((result == READ_FAILED) && (jobs > 1) && cache->can_split_categories()) {
+			split_fragments(&fragments, cache_fragments - fragments.begin(),
+				cache, &package_tree, dbheader, reused, jobs);
+			result = fragments_result(*cache_fragments);
+			print_fragment_errors(*cache_fragments);
+			replace = true;
+		}
+		if(result == READ_FAILED) {
+			read_cache(cache, &package_tree, reused);
 		} else {
-			if(use_percentage) {
-				reading_percent_status->init(
-					_("     Reading category %s|%s (%s%%)"),
-					package_tree.size());
-			} else {
-				reading_percent_status->init(eix::format(
-					_("     Reading up to %s categories of packages .. ")) %
-					package_tree.size());
-			}
-
-			/* iterator through categories */
-			bool aborted(false);
-			bool is_empty(true);
-			for(PackageTree::const_iterator ci(package_tree.begin());
-				unlikely(ci != package_tree.end()); ++ci) {
-				if(!cache->readCategoryPrepare(ci->first.c_str())) {
-					if(use_percentage) {
-						reading_percent_status->next();
-					}
-				} else {
-					if(use_percentage) {
-						reading_percent_status->next(eix::format(_(": %s ..")) % ci->first);
-					}
-					is_empty = false;
-					if(!cache->readCategory(ci->second)) {
-						aborted = true;
-					}
+			reading_percent_status = new PercentStatus;
+			reading_percent_status->init(_("     Reading Packages .. "));
+			string merge_error;
+			for(Fragments::const_iterator fragment(cache_fragments->begin());
+				likely(fragment != cache_fragments->end()); ++fragment) {
+				if(unlikely(!merge_fragment(&package_tree, fragment->file.c_str(), replace, &merge_error))) {
+					error_callback(merge_error);
+					result = READ_ABORTED;
+					break;
 				}
-				cache->readCategoryFinalize();
 			}
-			string msg(unlikely(is_empty) ? _("EMPTY!") :
-				(unlikely(aborted) ? _("ABORTED!") :
+			reading_percent_status->finish((result == READ_EMPTY) ? _("EMPTY!") :
+				((result == READ_ABORTED) ? _("ABORTED!") :
 					_("Finished")));
-			if(use_percentage) {
-				msg.insert(string::size_type(0), 1, ' ');
+			delete reading_percent_status;
+		}
+		for(Fragments::const_iterator fragment(cache_fragments->begin());
+			likely(fragment != cache_fragments->end()); ++fragment) {
+			if(!fragment->file.empty()) {
+				unlink(fragment->file.c_str());
 			}
-			reading_percent_status->finish(msg);
 		}
-		delete reading_percent_status;
 	}
 	statusline->print(eix::format(_("Analyzing")));
 
@@ -676,27 +1270,85 @@ static bool update(const char *outputfile, CacheTable *cache_table, PortageSetti
 	/* And write database back to disk .. */
 	statusline->print(eix::format("Creating %s") % outputfile);
 	INFO(eix::format(_("Writing database file %s ..\n")) % outputfile);
-	mode_t old_umask;
-	if(override_umask) {
-		old_umask = umask(2);
-	}
-	Database db;
-	bool ok(db.openwrite(outputfile));
-	if(override_umask) {
-		umask(old_umask);
-	}
-	if(unlikely(!ok)) {
-		if(errtext != NULLPTR) {
-			*errtext = eix::format(_("Can't open the database file %r for writing (mode = 'wb')")) % outputfile;
+	{
+		// Write a new file and rename it: Running eix instances map the
+		// old file and must not see it change (or shrink) under them.
+		string target(outputfile);
+		struct stat st;
+		bool have_old(lstat(outputfile, &st) == 0);
+		if(have_old && S_ISLNK(st.st_mode)) {
+			target = normalize_path(outputfile);
+			have_old = (stat(target.c_str(), &st) == 0);
+		}
+		string tmpname(eix::format("%s.%s") % target % getpid());
+		mode_t old_umask;
+		if(override_umask) {
+			old_umask = umask(2);
+		}
+		Database db;
+		bool ok(db.openwrite(tmpname.c_str(), compression));
+		if(unlikely(!ok)) {
+			// The directory is not writable: Overwrite the file in place
+			cerr << eix::format(_("Warning: cannot create %r; overwriting %r in place "
+				"(running eix processes may fail)")) % tmpname % outputfile << endl;
+			tmpname.clear();
+			ok = db.openwrite(outputfile, compression);
+		}
+		if(override_umask) {
+			umask(old_umask);
+		}
+		if(unlikely(!ok)) {
+			if(errtext != NULLPTR) {
+				*errtext = eix::format(_("Can't open the database file %r for writing (mode = 'wb')")) % outputfile;
+			}
+			return false;
 		}
-		return false;
-	}
 
-	dbheader.size = package_tree.countCategories();
+		dbheader.size = package_tree.countCategories();
 
-	if(!(likely(db.write_header(dbheader, errtext)) &&
-		likely(db.write_packagetree(package_tree, dbheader, errtext)))) {
-		return false;
+		if(!(likely(db.write_header(dbheader, errtext)) &&
+			likely(db.write_packagetree(package_tree, dbheader, errtext)) &&
+			likely(db.closewrite(errtext)))) {
+			if(!tmpname.empty()) {
+				unlink(tmpname.c_str());
+			}
+			return false;
+		}
+		if(!tmpname.empty()) {
+			if(have_old) {
+				// Keep owner and group if we are allowed to; chown() must
+				// come first since it can reset special bits of the mode
+				if(unlikely((chown(tmpname.c_str(), st.st_uid, st.st_gid) != 0) &&
+					(errno != EPERM))) {
+					cerr << eix::format(_("Warning: cannot change owner of %r")) % tmpname << endl;
+				}
+				chmod(tmpname.c_str(), st.st_mode & 07777);
+			}
+			if(unlikely(rename(tmpname.c_str(), target.c_str()) != 0)) {
+				unlink(tmpname.c_str());
+				if(errtext != NULLPTR) {
+					*errtext = eix::format(_("Can't rename %r to %r")) % tmpname % target;
+				}
+				return false;
+			}
+		}
+	}
+
+	/* The database must be closed to describe it in the fingerprints */
+	if(incremental) {
+		if(fingerprints.empty()) {
+			unlink(fingerprint_file.c_str());
+		} else {
+			mode_t old_umask;
+			if(override_umask) {
+				old_umask = umask(2);
+			}
+			write_fingerprints(fingerprint_file.c_str(),
+				fingerprint_setup(*cache_table, outputfile), fingerprints);
+			if(override_umask) {
+				umask(old_umask);
+			}
+		}
 	}
 
 	INFO(eix::format(_("Database contains %s packages in %s categories.\n"))
@@ -9,16 +9,21 @@
 
 #include <config.h>
 
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
 
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "database/header.h"
+#include "database/index.h"
 #include "database/package_reader.h"
 #include "eixTk/ansicolor.h"
 #include "eixTk/argsreader.h"
@@ -62,6 +67,7 @@ template<typename m_Type> class MaskList;
 
 using std::map;
 using std::string;
+using std::vector;
 
 using std::cerr;
 using std::cout;
@@ -74,6 +80,8 @@ static void parseFormat(const char *sourcename, const char *content) ATTRIBUTE_N
 static void set_format(EixRc *rc) ATTRIBUTE_NONNULL_;
 static void setup_defaults(EixRc *rc, bool is_tty) ATTRIBUTE_NONNULL_;
 static bool is_current_dbversion(const char *filename, const char *tooltext) ATTRIBUTE_NONNULL_;
+static bool parallel_search(DBIndex::Hits *hits, const DBIndex& index, Database *db, const DBHeader& header, PortageSettings *ps, MatchTree *matchtree, unsigned int jobs) ATTRIBUTE_NONNULL_;
+static bool search_range(int fd, Database *db, const DBHeader& header, PortageSettings *ps, MatchTree *matchtree, eix::OffsetType offset, eix::Catsize count) ATTRIBUTE_NONNULL_;
 static void print_wordvec(const WordVec& vec);
 static void print_unused(const string& filename, const string& excludefiles, const eix::ptr_list<Package>& packagelist, bool test_empty);
 static void print_removed(const string& dirname, const string& excludefiles, const eix::ptr_list<Package>& packagelist);
@@ -816,6 +824,27 @@ int run_eix(int argc, char** argv) {
 	eix::ptr_list<Package> matches;
 	eix::ptr_list<Package> all_packages; {
 		PackageReader reader(&db, header, &portagesettings);
+		reader.useLazy();
+		// If possible, look up the candidates in the index instead of reading all
+		DBIndex index;
+		DBIndex::Hits hits;
+		if(likely(!rc_options.test_unused) &&
+			db.read_index(&index, header, NULLPTR)) {
+			if(matchtree->index_lookup(&index, &hits)) {
+				reader.useIndex(&index, hits);
+			} else if(!(only_printed && (rc_options.brief || rc_options.brief2))) {
+				// Otherwise let several processes find the candidates
+				unsigned int jobs(eixrc.getInteger("SEARCH_JOBS"));
+				if(jobs == 0) {
+					long cpus(sysconf(_SC_NPROCESSORS_ONLN));
+					jobs = ((cpus > 0) ? static_cast<unsigned int>(cpus) : 1);
+				}
+				hits.clear();
+				if((jobs > 1) && parallel_search(&hits, index, &db, header, &portagesettings, matchtree, jobs)) {
+					reader.useIndex(&index, hits);
+				}
+			}
+		}
 		bool add_rest(false);
 		while(likely(reader.next())) {
 			if(unlikely(add_rest)) {
@@ -1108,6 +1137,162 @@ static bool is_current_dbversion(const char *filename, const char *tooltext) {
 	return db.read_header(&header, NULLPTR);
 }
 
+/**
+Run the search on count categories starting at offset and write the
+offsets of the matching packages to fd.
+This is the job of a forked process.
+**/
+static bool search_range(int fd, Database *db, const DBHeader& header, PortageSettings *ps, MatchTree *matchtree, eix::OffsetType offset, eix::Catsize count) {
+	PackageReader reader(db, header, ps);
+	reader.useLazy();
+	if(unlikely(!reader.useCategories(offset, count))) {
+		return false;
+	}
+	vector<eix::OffsetType> result;
+	while(likely(reader.next())) {
+		if(unlikely(matchtree->match(&reader))) {
+			result.push_back(reader.offset());
+		}
+		if(unlikely(!reader.skip())) {
+			return false;
+		}
+	}
+	if(unlikely(reader.get_errtext() != NULLPTR)) {
+		return false;
+	}
+	const char *buf(reinterpret_cast<const char *>(result.empty() ? NULLPTR : &(result[0])));
+	size_t len(result.size() * sizeof(eix::OffsetType));
+	while(len != 0) {
+		ssize_t r(write(fd, buf, len));
+		if(unlikely(r < 0)) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		buf += r;
+		len -= static_cast<size_t>(r);
+	}
+	return true;
+}
+
+/**
+Distribute the categories to jobs processes which collect the offsets
+of the matching packages in hits.
+The caller then needs to match only these packages once more; this way,
+all side effects of matching and the order of the output are kept.
+@return false if anything went wrong; the caller should search sequentially
+**/
+static bool parallel_search(DBIndex::Hits *hits, const DBIndex& index, Database *db, const DBHeader& header, PortageSettings *ps, MatchTree *matchtree, unsigned int jobs) {
+	// The forked processes would share the file position otherwise
+	if(unlikely(!db->mapped())) {
+		return false;
+	}
+	const DBIndex::CategoryTable& categories(index.categories);
+	eix::Treesize total(0);
+	for(DBIndex::CategoryTable::const_iterator it(categories.begin());
+		likely(it != categories.end()); ++it) {
+		total += it->size;
+	}
+	if(jobs > categories.size()) {
+		jobs = static_cast<unsigned int>(categories.size());
+	}
+	if((jobs <= 1) || (total == 0)) {
+		return false;
+	}
+
+	// Split into contiguous ranges with roughly the same number of packages
+	vector<DBIndex::CategoryTable::size_type> starts;
+	eix::Treesize sum(0);
+	for(DBIndex::CategoryTable::size_type i(0); likely(i != categories.size()); ++i) {
+		if((sum * jobs) >= (total * starts.size())) {
+			starts.push_back(i);
+		}
+		sum += categories[i].size;
+	}
+
+	cout.flush();
+	cerr.flush();
+	vector<pid_t> children;
+	vector<int> fds;
+	bool ok(true);
+	for(vector<DBIndex::CategoryTable::size_type>::size_type j(0);
+		likely(j != starts.size()); ++j) {
+		DBIndex::CategoryTable::size_type first(starts[j]);
+		DBIndex::CategoryTable::size_type last((j + 1 == starts.size()) ?
+			categories.size() : starts[j + 1]);
+		int pipefd[2];
+		if(unlikely(pipe(pipefd) != 0)) {
+			ok = false;
+			break;
+		}
+		pid_t child(fork());
+		if(unlikely(child == -1)) {
+			close(pipefd[0]);
+			close(pipefd[1]);
+			ok = false;
+			break;
+		}
+		if(child == 0) {
+			close(pipefd[0]);
+			bool success(search_range(pipefd[1], db, header, ps, matchtree,
+				categories[first].offset, static_cast<eix::Catsize>(last - first)));
+			close(pipefd[1]);
+			_exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+		close(pipefd[1]);
+		children.push_back(child);
+		fds.push_back(pipefd[0]);
+	}
+
+	// Read the results in the order of the ranges
+	for(vector<int>::const_iterator it(fds.begin()); likely(it != fds.end()); ++it) {
+		eix::OffsetType buf[512];
+		size_t have(0);
+		for(;;) {
+			ssize_t r(read(*it, reinterpret_cast<char *>(buf) + have, sizeof(buf) - have));
+			if(r == 0) {
+				break;
+			}
+			if(unlikely(r < 0)) {
+				if(errno == EINTR) {
+					continue;
+				}
+				ok = false;
+				break;
+			}
+			have += static_cast<size_t>(r);
+			size_t count(have / sizeof(eix::OffsetType));
+			hits->insert(buf, buf + count);
+			have -= count * sizeof(eix::OffsetType);
+			if(have != 0) {
+				std::memmove(buf, buf + count, have);
+			}
+		}
+		if(unlikely(have != 0)) {
+			ok = false;
+		}
+		close(*it);
+	}
+	for(vector<pid_t>::const_iterator it(children.begin());
+		likely(it != children.end()); ++it) {
+		int status;
+		while(waitpid(*it, &status, 0) != *it) {
+			if(errno != EINTR) {
+				status = -1;
+				break;
+			}
+		}
+		if(unlikely((status == -1) || !WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))) {
+			ok = false;
+		}
+	}
+	if(unlikely(!ok)) {
+		hits->clear();
+	}
+	return ok;
+}
+
 static void print_wordvec(const WordVec& vec) {
 	for(WordVec::const_iterator it(vec.begin());
 		likely(it != vec.end()); ++it) {
@@ -24,6 +24,7 @@
 #include "eixTk/inttypes.h"
 #include "eixTk/md5.h"
 #include "eixTk/null.h"
+#include "eixTk/stringutils.h"
 
 using std::string;
 
@@ -259,13 +260,7 @@ static void debug_md5(const uint32_t *resarr) {
 }
 #endif
 
-bool verify_md5sum(const char *file, const string& md5sum) {
-	if(md5sum.size() != 32) {
-		return false;
-	}
-	if(md5sum.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
-		return false;
-	}
+bool get_md5sum(const char *file, string *md5sum) {
 	char *filebuffer(NULLPTR);
 	int fd(open(file, O_RDONLY));
 	if(fd == -1) {
@@ -289,6 +284,8 @@ GCC_DIAG_OFF(old-style-cast)
 GCC_DIAG_ON(old-style-cast)
 			return false;
 		}
+	} else {
+		close(fd);
 	}
 	uint32_t resarr[4];
 	calc_md5sum(filebuffer, filesize, resarr);
@@ -296,33 +293,32 @@ GCC_DIAG_ON(old-style-cast)
 		munmap(filebuffer, filesize);
 	}
 #ifdef DEBUG_MD5
-	cout << "file: " << file << " size: "<< filesize << " should be: " <<  md5sum << " is: ";
+	cout << "file: " << file << " size: "<< filesize << " is: ";
 	debug_md5(resarr);
 #endif
-	string::size_type curr(0);
+	static const char hexdigits[] = "0123456789abcdef";
+	md5sum->clear();
 	for(int i(0); i < 4; ++i) {
 		uint32_t res(resarr[i]);
-		for(int j(0); j < 8; ++j) {
-			char c;
-			if((j & 1) == 0) {
-				c = ((res / 16) % 16);
-			} else {
-				c = (res % 16);
-				res /= 256;
-			}
-			if(c < 10) {
-				if(md5sum[curr] != ('0' + c)) {
-					return false;
-				}
-			} else {
-				c -= 10;
-				if(	(md5sum[curr] != ('a' + c)) &&
-					(md5sum[curr] != ('A' + c)) ) {
-					return false;
-				}
-			}
-			++curr;
+		for(int j(0); j < 4; ++j) {
+			md5sum->append(1, hexdigits[(res / 16) % 16]);
+			md5sum->append(1, hexdigits[res % 16]);
+			res /= 256;
 		}
 	}
 	return true;
 }
+
+bool verify_md5sum(const char *file, const string& md5sum) {
+	if(md5sum.size() != 32) {
+		return false;
+	}
+	if(md5sum.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+		return false;
+	}
+	string sum;
+	if(!get_md5sum(file, &sum)) {
+		return false;
+	}
+	return caseequal(md5sum, sum.c_str());
+}
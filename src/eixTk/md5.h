@@ -10,6 +10,9 @@
 
 #include <string>
 
+/// Calculate the md5sum of file as a lowercase hex string
+bool get_md5sum(const char *file, std::string *md5sum) ATTRIBUTE_NONNULL_;
+
 bool verify_md5sum(const char *file, const std::string& md5sum) ATTRIBUTE_NONNULL_;
 
 #endif  // SRC_EIXTK_MD5_H_
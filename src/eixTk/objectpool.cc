@@ -0,0 +1,64 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <cstddef>
+
+#include <new>
+
+#include "eixTk/constexpr.h"
+#include "eixTk/likely.h"
+#include "eixTk/objectpool.h"
+
+namespace eix {
+
+/// The alignment of each object; the global operator new gives at least this
+static CONSTEXPR size_t pool_align = 2 * sizeof(void *);
+
+/// The approximate size of each chunk
+static CONSTEXPR size_t pool_chunksize = 64 * 1024;
+
+ObjectPool::ObjectPool(size_t size) : m_size(size), m_used(0), m_free(NULLPTR), m_chunks(NULLPTR) {
+	m_block = ((size < sizeof(FreeNode)) ? sizeof(FreeNode) : size);
+	m_block = ((m_block + pool_align - 1) / pool_align) * pool_align;
+}
+
+void *ObjectPool::allocate_chunk(size_t size) {
+	if(unlikely(size != m_size)) {
+		return ::operator new(size);
+	}
+	size_t count(pool_chunksize / m_block);
+	if(unlikely(count < 2)) {
+		count = 2;
+	}
+	// The first pool_align bytes link the chunks
+	char *chunk(static_cast<char *>(::operator new(pool_align + count * m_block)));
+	*reinterpret_cast<void **>(chunk) = m_chunks;
+	m_chunks = chunk;
+	chunk += pool_align;
+	// Keep the first object and put the others into the free list
+	for(char *p(chunk + (count - 1) * m_block); likely(p != chunk); p -= m_block) {
+		FreeNode *node(reinterpret_cast<FreeNode *>(p));
+		node->next = m_free;
+		m_free = node;
+	}
+	++m_used;
+	return chunk;
+}
+
+void ObjectPool::release() {
+	while(m_chunks != NULLPTR) {
+		void *next(*static_cast<void **>(m_chunks));
+		::operator delete(m_chunks);
+		m_chunks = next;
+	}
+	m_free = NULLPTR;
+	m_used = 0;
+}
+
+}  // namespace eix
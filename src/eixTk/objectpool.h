@@ -0,0 +1,80 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_EIXTK_OBJECTPOOL_H_
+#define SRC_EIXTK_OBJECTPOOL_H_ 1
+
+#include <cstddef>
+
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+
+namespace eix {
+
+/**
+Allocate objects of one size in chunks and keep freed objects for reuse.
+This avoids the overhead of malloc for the many small objects of a
+package tree. The chunks are released in bulk as soon as no object of
+the pool is in use any more, e.g. when the last package tree is deleted.
+Objects of a different size (e.g. of derived classes) are passed
+to the global operator new/delete.
+**/
+class ObjectPool {
+	public:
+		explicit ObjectPool(size_t size);
+
+		~ObjectPool() {
+			release();
+		}
+
+		void *allocate(size_t size) {
+			if(likely((size == m_size) && (m_free != NULLPTR))) {
+				FreeNode *node(m_free);
+				m_free = node->next;
+				++m_used;
+				return node;
+			}
+			return allocate_chunk(size);
+		}
+
+		void deallocate(void *p, size_t size) {
+			if(unlikely(p == NULLPTR)) {
+				return;
+			}
+			if(unlikely(size != m_size)) {
+				::operator delete(p);
+				return;
+			}
+			FreeNode *node(static_cast<FreeNode *>(p));
+			node->next = m_free;
+			m_free = node;
+			if(unlikely(--m_used == 0)) {
+				release();
+			}
+		}
+
+	private:
+		struct FreeNode {
+			FreeNode *next;
+		};
+
+		/// m_used is the number of objects currently allocated from the chunks
+		size_t m_size, m_block, m_used;
+		FreeNode *m_free;
+
+		/// The chunks, each linked to the next through its first bytes
+		void *m_chunks;
+
+		void *allocate_chunk(size_t size);
+
+		/// Free all chunks; no object of the pool may be in use
+		void release();
+};
+
+}  // namespace eix
+
+#endif  // SRC_EIXTK_OBJECTPOOL_H_
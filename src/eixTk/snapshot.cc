@@ -0,0 +1,181 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "eixTk/diagnostics.h"
+#include "eixTk/formated.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/snapshot.h"
+#include "eixTk/stringtypes.h"
+#include "eixTk/stringutils.h"
+#include "eixTk/utils.h"
+
+using std::make_pair;
+using std::ofstream;
+using std::string;
+
+void snapshot_add_string(string *out, const string& s) {
+	out->append(s);
+	out->append(1, '\0');
+}
+
+void snapshot_add_number(string *out, WordVec::size_type n) {
+	snapshot_add_string(out, eix::format("%s") % n);
+}
+
+void snapshot_add_stamp(string *out, const char *file, bool recursive) {
+	struct stat st;
+	if(stat(file, &st) != 0) {
+		snapshot_add_string(out, "-");
+		return;
+	}
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+	// A file changed within the same second must get another stamp
+	snapshot_add_string(out, eix::format("%s:%s.%s:%s") %
+		st.st_ino % st.st_mtime % st.st_mtim.tv_nsec % st.st_size);
+#else
+	snapshot_add_string(out, eix::format("%s:%s:%s") %
+		st.st_ino % st.st_mtime % st.st_size);
+#endif
+	if(!(recursive && S_ISDIR(st.st_mode))) {
+		return;
+	}
+	WordVec files;
+	string dir(file);
+	dir.append(1, '/');
+	pushback_files(dir, &files, pushback_lines_exclude, 3);
+	snapshot_add_number(out, files.size());
+	for(WordVec::const_iterator it(files.begin()); likely(it != files.end()); ++it) {
+		snapshot_add_string(out, *it);
+		snapshot_add_stamp(out, it->c_str(), true);
+	}
+}
+
+bool snapshot_read(const char *file, string *content) {
+	int fd(open(file, O_RDONLY));
+	if(fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if(unlikely(fstat(fd, &st) != 0)) {
+		close(fd);
+		return false;
+	}
+GCC_DIAG_OFF(sign-conversion)
+	content->resize(st.st_size);
+	string::size_type done(0);
+	while(done < content->size()) {
+		ssize_t r(read(fd, &((*content)[done]), content->size() - done));
+		if(r <= 0) {
+			break;
+		}
+		done += r;
+	}
+GCC_DIAG_ON(sign-conversion)
+	close(fd);
+	return (done == content->size());
+}
+
+void snapshot_write(const string& file, const string& content) {
+	// Write atomically so that parallel eix instances do not interfere
+	string tmpfile(eix::format("%s.%s") % file % getpid());
+	{
+		ofstream os(tmpfile.c_str(), std::ios::out | std::ios::binary);
+		if(unlikely(!os.is_open())) {
+			// Perhaps the directory needs to be created
+			string::size_type slash(file.rfind('/'));
+			if((slash == string::npos) || (slash == 0) ||
+				(mkdir(file.substr(0, slash).c_str(), 0700) != 0)) {
+				return;
+			}
+			os.open(tmpfile.c_str(), std::ios::out | std::ios::binary);
+			if(unlikely(!os.is_open())) {
+				return;
+			}
+		}
+		os.write(content.c_str(), content.size());
+		if(unlikely(!os.good())) {
+			os.close();
+			std::remove(tmpfile.c_str());
+			return;
+		}
+	}
+	if(unlikely(std::rename(tmpfile.c_str(), file.c_str()) != 0)) {
+		std::remove(tmpfile.c_str());
+	}
+}
+
+const char *SnapshotReader::get() {
+	const char *s(p);
+GCC_DIAG_OFF(sign-conversion)
+	const char *z(static_cast<const char *>(memchr(p, '\0', end - p)));
+GCC_DIAG_ON(sign-conversion)
+	if(unlikely(z == NULLPTR)) {
+		return NULLPTR;
+	}
+	p = z + 1;
+	return s;
+}
+
+bool SnapshotReader::get(string *s) {
+	const char *r(get());
+	if(unlikely(r == NULLPTR)) {
+		return false;
+	}
+	s->assign(r);
+	return true;
+}
+
+bool SnapshotReader::get_number(WordVec::size_type *n) {
+	const char *r(get());
+	if(unlikely(r == NULLPTR)) {
+		return false;
+	}
+	*n = my_atoi(r);
+	return true;
+}
+
+bool SnapshotReader::get_map(WordMap *m) {
+	WordVec::size_type count;
+	if(unlikely(!get_number(&count))) {
+		return false;
+	}
+	for(; likely(count != 0); --count) {
+		const char *key(get());
+		const char *value(get());
+		if(unlikely(value == NULLPTR)) {
+			return false;
+		}
+		m->insert(m->end(), make_pair(string(key), string(value)));
+	}
+	return true;
+}
+
+const char *SnapshotReader::skip(WordVec::size_type length) {
+GCC_DIAG_OFF(sign-conversion)
+	if(unlikely(length > static_cast<WordVec::size_type>(end - p))) {
+		return NULLPTR;
+	}
+	const char *s(p);
+	p += length;
+GCC_DIAG_ON(sign-conversion)
+	return s;
+}
@@ -0,0 +1,62 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_EIXTK_SNAPSHOT_H_
+#define SRC_EIXTK_SNAPSHOT_H_ 1
+
+#include <string>
+
+#include "eixTk/null.h"
+#include "eixTk/stringtypes.h"
+
+/**
+Snapshot files consist of \0-terminated strings;
+numbers are stored as decimal strings.
+**/
+
+void snapshot_add_string(std::string *out, const std::string& s) ATTRIBUTE_NONNULL_;
+
+void snapshot_add_number(std::string *out, WordVec::size_type n) ATTRIBUTE_NONNULL_;
+
+/// Append "inode:mtime.nsec:size" of file (or "-" if it does not exist);
+/// if recursive, also of the files which pushback_lines would read
+void snapshot_add_stamp(std::string *out, const char *file, bool recursive) ATTRIBUTE_NONNULL_;
+
+/// Read the whole file into content
+bool snapshot_read(const char *file, std::string *content) ATTRIBUTE_NONNULL_;
+
+/// Replace file by content, creating the directory of file if necessary.
+/// Errors are silently ignored.
+void snapshot_write(const std::string& file, const std::string& content);
+
+class SnapshotReader {
+	public:
+		SnapshotReader(const char *buffer, const char *buffer_end) : p(buffer), end(buffer_end) {
+		}
+
+		/// @return NULLPTR if there is no further string
+		const char *get();
+
+		bool get(std::string *s) ATTRIBUTE_NONNULL_;
+
+		bool get_number(WordVec::size_type *n) ATTRIBUTE_NONNULL_;
+
+		/// Read a map written with its keys in sorted order
+		bool get_map(WordMap *m) ATTRIBUTE_NONNULL_;
+
+		/// Skip length bytes (of a nested snapshot)
+		const char *skip(WordVec::size_type length);
+
+		bool at_end() const {
+			return (p == end);
+		}
+
+	private:
+		const char *p, *end;
+};
+
+#endif  // SRC_EIXTK_SNAPSHOT_H_
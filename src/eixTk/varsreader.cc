@@ -978,6 +978,9 @@ bool VarsReader::readmem(const char *buffer, const char *buffer_end, string *err
 }
 
 bool VarsReader::read(const char *filename, string *errtext, bool noexist_ok, set<string> *sourced, bool nodir) {
+	if(unlikely(read_files != NULLPTR)) {
+		read_files->push_back(filename);
+	}
 	if((!nodir) && ((parse_flags & RECURSE) != NONE)) {
 		string dir(filename);
 		dir.append(1, '/');
@@ -1103,6 +1106,7 @@ bool VarsReader::source(const string& filename, string *errtext) {
 	includefile.accumulatingKeys(incremental_keys);
 	includefile.useMap(vars);
 	includefile.setPrefix(source_prefix);
+	includefile.trackFiles(read_files);
 	string currprefix(source_prefix);
 	if((parse_flags & ALLOW_SOURCE_VARNAME) == ALLOW_SOURCE_VARNAME) {
 		if(vars != NULLPTR) {
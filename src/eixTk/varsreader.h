@@ -47,7 +47,7 @@ class VarsReader {
 
 
 		/** Init and parse the FSM depending on supplied flags. */
-		explicit VarsReader(Flags flags) {
+		explicit VarsReader(Flags flags) : read_files(NULLPTR) {
 			if((flags & PORTAGE_SECTIONS) != NONE) {
 				flags |= PORTAGE_ESCAPES;
 			}
@@ -82,6 +82,12 @@ class VarsReader {
 			vars = vars_map;
 		}
 
+		/** Append the names of all files (also sourced, missing or
+		    directories) which we attempt to read to files */
+		void trackFiles(WordVec *files) {
+			read_files = files;
+		}
+
 		/** Prefix (path resp. varname) used for sourcing */
 		void setPrefix(const std::string& prefix) {
 			source_prefix = prefix;
@@ -297,6 +303,7 @@ class VarsReader {
 
 	protected:
 		WordSet *sourced_files;
+		WordVec *read_files;
 
 		std::string m_errtext;
 
@@ -206,6 +206,24 @@ AddOption(STRING, "EBUILD_DEPEND_TEMP",
 	"%{EPREFIX_PORTAGE_EXEC}/var/cache/edb/dep/aux_db_key_temp", _(
 	"The path to the tempfile generated by \"ebuild depend\"."));
 
+AddOption(STRING, "EBUILD_RESULTS_DIR",
+	"", _(
+	"If nonempty, the results of ebuilds executed for the cache methods\n"
+	"ebuild and ebuild* are stored below this directory and reused as long\n"
+	"as the ebuild and its eclasses do not change."));
+
+AddOption(STRING, "EBUILD_MD5_CACHE",
+	"%{EIX_CACHEFILE}.md5", _(
+	"If nonempty, the md5sums of ebuilds calculated for the verification with\n"
+	"metadata-md5 are stored in this file and reused as long as inode, mtime,\n"
+	"and size of the ebuild do not change."));
+
+AddOption(STRING, "PROFILE_CACHE",
+	"%{??XDG_CACHE_HOME}%{XDG_CACHE_HOME}%{else}%{HOME}/.cache%{}/eix-profile.cache", _(
+	"If nonempty, the parsed entries of the profile and of the user's\n"
+	"package.keywords and package.accept_keywords are stored in this file\n"
+	"and reused as long as inode, mtime, and size of the read files do not change."));
+
 AddOption(STRING, "EIX_WORLD",
 	"%{EPREFIX_ROOT}/var/lib/portage/world", _(
 	"This file is considered as the world file."));
@@ -283,6 +301,11 @@ AddOption(BOOLEAN, "QUICKMODE",
 	"false", _(
 	"Whether --quick is on by default."));
 
+AddOption(INTEGER, "SEARCH_JOBS",
+	"1", _(
+	"The number of processes used for searching the database.\n"
+	"The value 0 means the number of available processors."));
+
 AddOption(BOOLEAN, "CAREMODE",
 	"false", _(
 	"Whether --care is on."));
@@ -450,6 +473,23 @@ AddOption(BOOLEAN, "UPDATE_VERBOSE",
 	"false", _(
 	"Whether eix-update -v is on by default (output cache method per ebuild)"));
 
+AddOption(INTEGER, "UPDATE_JOBS",
+	"1", _(
+	"The default for eix-update --jobs.\n"
+	"The value 0 means the number of available processors."));
+
+AddOption(BOOLEAN, "UPDATE_INCREMENTAL",
+	"false", _(
+	"If true, eix-update copies categories from the previous database if\n"
+	"the fingerprints of their cache files did not change.\n"
+	"This is only possible if all overlays use metadata* cache methods."));
+
+AddOption(STRING, "DATABASE_COMPRESSION",
+	"none", _(
+	"The compression used by eix-update when writing the database.\n"
+	"Possible values are \"none\" and (if compiled with zlib support) \"zlib\".\n"
+	"eix reads compressed and uncompressed databases alike."));
+
 AddOption(STRING, "CACHE_METHOD_PARSE",
 	"#metadata-md5#metadata-flat#assign", _(
 	"This string is appended to all cache methods using parse[*] or ebuild[*]."));
@@ -193,6 +193,17 @@ void EixRc::read() {
 	}
 	modify_value(&m_eprefixconf, name);
 
+	// On warm runs, all of the following is taken from the cache
+	default_index original_size(defaults.size());
+	string cache, stamp;
+	bool use_cache(cache_file(&cache));
+	if(likely(use_cache)) {
+		stamp = cache_stamp(original_size);
+		if(likely(read_cache(cache, stamp, original_size))) {
+			return;
+		}
+	}
+
 	set<string> has_delayed;
 
 	// First, we create defaults and main_map with all variables
@@ -205,6 +216,10 @@ void EixRc::read() {
 
 	// set m_eprefixconf to possibly new settings:
 	m_eprefixconf = (*this)["PORTAGE_CONFIGROOT"];
+
+	if(likely(use_cache)) {
+		write_cache(cache, stamp, original_size);
+	}
 }
 
 const string& EixRc::operator[](const string& key) {
@@ -415,6 +430,7 @@ void EixRc::read_undelayed(set<string> *has_delayed) {
 			|VarsReader::RECURSE);
 	rc.useMap(&filevarmap);
 	rc.setPrefix("EIXRC_SOURCE");
+	rc.trackFiles(&rc_files);
 
 	const char *rc_file(getenv("EIXRC"));
 	string errtext;
@@ -452,12 +468,8 @@ void EixRc::read_undelayed(set<string> *has_delayed) {
 	if(wide.empty() || (wide == "auto")) {
 		string& c(filevarmap["COLUMNS"]);
 		if(c.empty() || (c == "auto")) {
-			unsigned int lines, columns;
-			if(get_geometry(&lines, &columns)) {
-				wide = ((columns > 80) ? "true" : "false");
-			} else {
-				wide.clear();
-			}
+			wideterm_auto = true;
+			wide = auto_wideterm();
 		} else {
 			wide = ((my_atoi(c.c_str()) > 80) ? "true" : "false");
 		}
@@ -669,6 +681,14 @@ EixRc::DelayedType EixRc::find_next_delayed(const string& str, string::size_type
 	}
 }
 
+const char *EixRc::auto_wideterm() {
+	unsigned int lines, columns;
+	if(get_geometry(&lines, &columns)) {
+		return ((columns > 80) ? "true" : "false");
+	}
+	return "";
+}
+
 void EixRc::modify_value(string *value, const string& key) {
 	if(*value == "/") {
 		if(prefix_keys.find(key) != prefix_keys.end())
@@ -681,6 +701,8 @@ void EixRc::clear() {
 	prefix_keys.clear();
 	filevarmap.clear();
 	main_map.clear();
+	rc_files.clear();
+	wideterm_auto = false;
 }
 
 void EixRc::addDefault(EixRcOption option) {
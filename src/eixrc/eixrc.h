@@ -21,6 +21,7 @@
 #include "eixTk/constexpr.h"
 #include "eixTk/eixint.h"
 #include "eixTk/inttypes.h"
+#include "eixTk/stringtypes.h"
 #include "portage/keywords.h"
 #include "search/redundancy.h"
 
@@ -42,7 +43,7 @@ class EixRc {
 	public:
 		std::string m_eprefixconf;
 
-		explicit EixRc(const char *prefix) ATTRIBUTE_NONNULL_ : varprefix(prefix) {
+		explicit EixRc(const char *prefix) ATTRIBUTE_NONNULL_ : varprefix(prefix), wideterm_auto(false) {
 		}
 
 		typedef std::vector<EixRcOption>::size_type default_index;
@@ -88,10 +89,15 @@ class EixRc {
 		my_map filevarmap;
 		std::vector<EixRcOption> defaults;
 		std::set<std::string> prefix_keys;
+		/// All files which were (attempted to be) read by read_undelayed
+		WordVec rc_files;
+		/// Whether read_undelayed determined WIDETERM from the terminal
+		bool wideterm_auto;
 
 		enum DelayedType { DelayedNotFound, DelayedVariable, DelayedIfTrue, DelayedIfFalse, DelayedIfNonempty, DelayedIfEmpty, DelayedElse, DelayedFi, DelayedQuote };
 
 		static bool istrue(const char *s) ATTRIBUTE_PURE;
+		static const char *auto_wideterm();
 		static bool getRedundantFlagAtom(const char *s, Keywords::Redundant type, RedAtom *r) ATTRIBUTE_NONNULL((3));
 
 		void modify_value(std::string *value, const std::string& key);
@@ -116,6 +122,17 @@ class EixRc {
 		void join_key_rec(const std::string& key, const std::string& val, std::set<std::string> *has_delayed, const std::set<std::string> *exclude_defaults) ATTRIBUTE_NONNULL((4));
 		void join_key_if_new(const std::string& key, std::set<std::string> *has_delayed, const std::set<std::string> *exclude_defaults) ATTRIBUTE_NONNULL((3));
 
+		/** The cache of the resolved variables (implemented in
+		    eixrc_cache.cc) is used only if cache_file returns true */
+		bool cache_file(std::string *file) const ATTRIBUTE_NONNULL_;
+		std::string cache_stamp(default_index original_size) const;
+		void env_stamp(WordVec *env, const my_map& vars, const my_map& filevars) const ATTRIBUTE_NONNULL_;
+		static void files_stamp(std::string *stamp, const WordVec& files) ATTRIBUTE_NONNULL_;
+		/** Fill main_map, filevarmap, and defaults from the cache file.
+		    @return false if the cache is missing or outdated */
+		bool read_cache(const std::string& file, const std::string& stamp, default_index original_size);
+		void write_cache(const std::string& file, const std::string& stamp, default_index original_size) const;
+
 		typedef uint8_t DelayvarFlags;
 		static CONSTEXPR DelayvarFlags
 			DELAYVAR_NONE   = 0x00,
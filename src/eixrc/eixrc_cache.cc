@@ -0,0 +1,274 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <string>
+#include <vector>
+
+#include "eixTk/formated.h"
+#include "eixTk/inttypes.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/snapshot.h"
+#include "eixTk/stringtypes.h"
+#include "eixrc/eixrc.h"
+
+extern char **environ;
+
+using std::sort;
+using std::string;
+using std::vector;
+
+#define EIXRC_CACHE_MAGIC "eixrc-cache 1"
+
+/**
+The cache file is a snapshot (see eixTk/snapshot.h) with the entries:
+magic, stamp of eix and the defaults,
+number of files, their names, and their stamps,
+number of relevant environment entries and these entries,
+result of the terminal width test (or "-" if there was none),
+the resolved m_eprefixconf,
+number of defaults and their local_value (with key for locally added),
+number of main_map entries and their key and value,
+number of the remaining filevarmap entries and their key and value.
+**/
+
+static void add_map(string *out, const WordMap& m, const WordMap *exclude) ATTRIBUTE_NONNULL((1));
+static void add_hash(uint32_t *hash, const string& s) ATTRIBUTE_NONNULL_;
+
+static void add_map(string *out, const WordMap& m, const WordMap *exclude) {
+	vector<WordMap::const_iterator> entries;
+	for(WordMap::const_iterator it(m.begin()); likely(it != m.end()); ++it) {
+		if((exclude == NULLPTR) || (exclude->find(it->first) == exclude->end())) {
+			entries.push_back(it);
+		}
+	}
+	snapshot_add_number(out, entries.size());
+	for(vector<WordMap::const_iterator>::const_iterator it(entries.begin());
+		likely(it != entries.end()); ++it) {
+		snapshot_add_string(out, (*it)->first);
+		snapshot_add_string(out, (*it)->second);
+	}
+}
+
+/// FNV-1a; the terminating \0 is hashed as a separator
+static void add_hash(uint32_t *hash, const string& s) {
+	const char *c(s.c_str());
+	do {
+		*hash ^= static_cast<unsigned char>(*c);
+		*hash *= 16777619U;
+	} while(*(c++) != '\0');
+}
+
+/** Each program has its own file, since the stamp contains varprefix */
+bool EixRc::cache_file(string *file) const {
+	const char *name(getenv("EIXRC_CACHE"));
+	if(name != NULLPTR) {
+		if(*name == '\0') {
+			return false;
+		}
+		file->assign(name);
+	} else {
+		name = getenv("XDG_CACHE_HOME");
+		if((name != NULLPTR) && (*name != '\0')) {
+			file->assign(name);
+		} else {
+			name = getenv("HOME");
+			if(unlikely(name == NULLPTR)) {
+				return false;
+			}
+			file->assign(name);
+			file->append("/.cache");
+		}
+		file->append("/eixrc");
+	}
+	file->append(eix::format("-%s.cache") % varprefix);
+	return true;
+}
+
+/** The stamp changes whenever the defaults (i.e. the eix binary)
+    or the initial configuration prefix change */
+string EixRc::cache_stamp(default_index original_size) const {
+	uint32_t hash(2166136261U);
+	for(default_index i(0); likely(i < original_size); ++i) {
+		const EixRcOption& option(defaults[i]);
+		add_hash(&hash, eix::format("%s") % static_cast<int>(option.type));
+		add_hash(&hash, option.key);
+		add_hash(&hash, option.value);
+	}
+	return eix::format("%s %s %s %s %s") % PACKAGE_VERSION % varprefix %
+		original_size % hash % m_eprefixconf;
+}
+
+/** Collect all environment entries which might have been used for
+    a variable of vars or filevars (or for finding the config files) */
+void EixRc::env_stamp(WordVec *env, const my_map& vars, const my_map& filevars) const {
+	for(char **e(environ); likely(*e != NULLPTR); ++e) {
+		const char *eq(strchr(*e, '='));
+		if(unlikely(eq == NULLPTR)) {
+			continue;
+		}
+		string name(*e, eq - *e);
+		if((vars.find(name) == vars.end()) &&
+			(filevars.find(name) == filevars.end()) &&
+			(name != "EIXRC") && (name != "HOME") &&
+			(name != "EIX_PREFIX") && (name != "PORTAGE_CONFIGROOT")) {
+			continue;
+		}
+		env->push_back(*e);
+	}
+	sort(env->begin(), env->end());
+}
+
+void EixRc::files_stamp(string *stamp, const WordVec& files) {
+	for(WordVec::const_iterator it(files.begin()); likely(it != files.end()); ++it) {
+		snapshot_add_stamp(stamp, it->c_str(), false);
+	}
+}
+
+bool EixRc::read_cache(const string& file, const string& stamp, default_index original_size) {
+	string content;
+	if(!snapshot_read(file.c_str(), &content)) {
+		return false;
+	}
+	SnapshotReader buf(content.c_str(), content.c_str() + content.size());
+	const char *s(buf.get());
+	if(unlikely((s == NULLPTR) || (strcmp(s, EIXRC_CACHE_MAGIC) != 0))) {
+		return false;
+	}
+	s = buf.get();
+	if(unlikely((s == NULLPTR) || (stamp != s))) {
+		return false;
+	}
+
+	// Have any of the config files changed?
+	WordVec::size_type count;
+	if(unlikely(!buf.get_number(&count))) {
+		return false;
+	}
+	WordVec files;
+	for(; likely(count != 0); --count) {
+		files.push_back(string());
+		if(unlikely(!buf.get(&files.back()))) {
+			return false;
+		}
+	}
+	string current;
+	files_stamp(&current, files);
+	s = buf.skip(current.size());
+	if((s == NULLPTR) || (memcmp(s, current.c_str(), current.size()) != 0)) {
+		return false;
+	}
+
+	// The environment is checked after the variable names are known
+	WordVec env;
+	if(unlikely(!buf.get_number(&count))) {
+		return false;
+	}
+	for(; likely(count != 0); --count) {
+		env.push_back(string());
+		if(unlikely(!buf.get(&env.back()))) {
+			return false;
+		}
+	}
+
+	s = buf.get();
+	if(unlikely(s == NULLPTR)) {
+		return false;
+	}
+	bool auto_wide(strcmp(s, "-") != 0);
+	if(unlikely(auto_wide && (strcmp(s, auto_wideterm()) != 0))) {
+		return false;
+	}
+
+	string eprefixconf;
+	if(unlikely(!buf.get(&eprefixconf))) {
+		return false;
+	}
+
+	WordVec::size_type total;
+	if(unlikely((!buf.get_number(&total)) || (total < original_size))) {
+		return false;
+	}
+	vector<const char *> local_values;
+	for(WordVec::size_type i(0); likely(i < total); ++i) {
+		if(unlikely(i >= original_size)) {
+			local_values.push_back(buf.get());
+		}
+		local_values.push_back(buf.get());
+		if(unlikely(local_values.back() == NULLPTR)) {
+			return false;
+		}
+	}
+
+	my_map vars, filevars;
+	if(unlikely((!buf.get_map(&vars)) || (!buf.get_map(&filevars)))) {
+		return false;
+	}
+	WordVec current_env;
+	env_stamp(&current_env, vars, filevars);
+	if(current_env != env) {
+		return false;
+	}
+
+	// The cache is valid: Use it
+	vector<const char *>::const_iterator it(local_values.begin());
+	for(default_index i(0); likely(i < original_size); ++i) {
+		defaults[i].local_value.assign(*(it++));
+	}
+	while(it != local_values.end()) {
+		const char *key(*(it++));
+		defaults.push_back(EixRcOption(EixRcOption::LOCAL, key, *(it++), ""));
+	}
+	main_map.swap(vars);
+	filevarmap.swap(filevars);
+	rc_files.swap(files);
+	wideterm_auto = auto_wide;
+	m_eprefixconf.swap(eprefixconf);
+	return true;
+}
+
+void EixRc::write_cache(const string& file, const string& stamp, default_index original_size) const {
+	string out;
+	snapshot_add_string(&out, EIXRC_CACHE_MAGIC);
+	snapshot_add_string(&out, stamp);
+
+	snapshot_add_number(&out, rc_files.size());
+	for(WordVec::const_iterator it(rc_files.begin()); likely(it != rc_files.end()); ++it) {
+		snapshot_add_string(&out, *it);
+	}
+	files_stamp(&out, rc_files);
+
+	WordVec env;
+	env_stamp(&env, main_map, filevarmap);
+	snapshot_add_number(&out, env.size());
+	for(WordVec::const_iterator it(env.begin()); likely(it != env.end()); ++it) {
+		snapshot_add_string(&out, *it);
+	}
+
+	snapshot_add_string(&out, (wideterm_auto ? auto_wideterm() : "-"));
+	snapshot_add_string(&out, m_eprefixconf);
+
+	snapshot_add_number(&out, defaults.size());
+	for(default_index i(0); likely(i < defaults.size()); ++i) {
+		if(unlikely(i >= original_size)) {
+			snapshot_add_string(&out, defaults[i].key);
+		}
+		snapshot_add_string(&out, defaults[i].local_value);
+	}
+
+	// Values of filevarmap are only needed for keys missing in main_map
+	add_map(&out, main_map, NULLPTR);
+	add_map(&out, filevarmap, &main_map);
+
+	snapshot_write(file, out);
+}
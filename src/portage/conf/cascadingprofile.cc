@@ -23,11 +23,13 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/snapshot.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/sysutils.h"
 #include "eixTk/utils.h"
 #include "portage/conf/cascadingprofile.h"
 #include "portage/conf/portagesettings.h"
+#include "portage/conf/profilesnapshot.h"
 #include "portage/mask.h"
 #include "portage/mask_list.h"
 
@@ -161,29 +163,78 @@ void CascadingProfile::init_static() {
 	profile_filenames = new ProfileFilenames;
 }
 
-bool CascadingProfile::readremoveFiles() {
+void CascadingProfile::queueFiles() {
 	eix_assert_static(profile_filenames != NULLPTR);
-	bool ret(false);
-	for(ProfileFiles::iterator file(m_profile_files.begin());
+	for(ProfileFiles::const_iterator file(m_profile_files.begin());
 		likely(file != m_profile_files.end()); ++file) {
 		const char *filename(strrchr(file->c_str(), '/'));
 		if(filename == NULLPTR)
 			continue;
-		++filename;
-		CascadingProfile::Handler handler((*profile_filenames)[filename]);
-		if(handler == NULLPTR) {
-			continue;
+		if((*profile_filenames)[filename + 1] != NULLPTR) {
+			m_read_files.push_back(*file);
 		}
+	}
+	m_profile_files.clear();
+}
 
-		OverlayIdent& overlay(m_portagesettings->repos[file->reponum]);
+void CascadingProfile::readFiles() {
+	for(ProfileFiles::size_type i(0); likely(i < m_read_files.size()); ++i) {
+		const ProfileFile& file(m_read_files[i]);
+		CascadingProfile::Handler handler((*profile_filenames)[strrchr(file.c_str(), '/') + 1]);
+		OverlayIdent& overlay(m_portagesettings->repos[file.reponum]);
 		overlay.readLabel();
-		if((this->*handler)(file->name(),
-			overlay.label.empty() ? NULLPTR : overlay.label.c_str())) {
-			ret = true;
+		if((this->*handler)(file.name(),
+			overlay.label.empty() ? NULLPTR : overlay.label.c_str()) &&
+			(i >= m_changes_from)) {
+			m_changed = true;
 		}
 	}
-	m_profile_files.clear();
-	return ret;
+	m_read_files.clear();
+	m_changes_from = 0;
+}
+
+string CascadingProfile::snapshotKey() {
+	string key;
+	snapshot_add_string(&key, "profile");
+	snapshot_add_number(&key, m_changes_from);
+	for(ProfileFiles::const_iterator file(m_read_files.begin());
+		likely(file != m_read_files.end()); ++file) {
+		OverlayIdent& overlay(m_portagesettings->repos[file->reponum]);
+		overlay.readLabel();
+		snapshot_add_string(&key, file->name());
+		snapshot_add_string(&key, overlay.label);
+		snapshot_add_stamp(&key, file->c_str(), true);
+	}
+	return key;
+}
+
+void CascadingProfile::serialize(string *out) {
+	snapshot_add_number(out, (m_changed ? 1 : 0));
+	p_system.serialize(out);
+	p_profile.serialize(out);
+	p_package_masks.serialize(out);
+	p_package_unmasks.serialize(out);
+	p_package_keywords.serialize(out);
+	p_package_accept_keywords.serialize(out);
+}
+
+bool CascadingProfile::restore(const string& data) {
+	SnapshotReader reader(data.c_str(), data.c_str() + data.size());
+	WordVec::size_type changed;
+	if(likely(reader.get_number(&changed) &&
+		p_system.restore(&reader) &&
+		p_profile.restore(&reader) &&
+		p_package_masks.restore(&reader) &&
+		p_package_unmasks.restore(&reader) &&
+		p_package_keywords.restore(&reader) &&
+		p_package_accept_keywords.restore(&reader) &&
+		reader.at_end())) {
+		m_changed = (changed != 0);
+		return true;
+	}
+	p_system = p_profile = p_package_masks = p_package_unmasks =
+		p_package_keywords = p_package_accept_keywords = PreList();
+	return false;
 }
 
 bool CascadingProfile::readPackages(const string& filename, const char *repo) {
@@ -253,20 +304,40 @@ void CascadingProfile::readMakeDefaults() {
 	}
 }
 
-/** Populate MaskLists from PreLists.
-    All files must have been read and m_raised_arch
+/** Read the queued files (or take their data from snapshot),
+    and populate MaskLists from PreLists.
+    All files must have been queued and m_raised_arch
     must be known when this is called. */
-void CascadingProfile::finalize() {
+bool CascadingProfile::finalize(ProfileSnapshot *snapshot) {
 	if(finalized) {
-		return;
+		return m_changed;
 	}
 	finalized = true;
+	if(!m_read_files.empty()) {
+		string key;
+		const string *data(NULLPTR);
+		if(snapshot->enabled()) {
+			key = snapshotKey();
+			data = snapshot->find(key);
+		}
+		if((data == NULLPTR) || unlikely(!restore(*data))) {
+			readFiles();
+			if(!key.empty()) {
+				string out;
+				serialize(&out);
+				snapshot->store(key, out);
+			}
+		}
+		m_read_files.clear();
+		m_changes_from = 0;
+	}
 	p_system.initialize(&m_system, Mask::maskInSystem);
 	p_profile.initialize(&m_profile, Mask::maskInProfile);
 	p_package_masks.initialize(&m_package_masks, Mask::maskMask, true);
 	p_package_unmasks.initialize(&m_package_unmasks, Mask::maskUnmask);
 	p_package_keywords.initialize(&m_package_keywords);
 	p_package_accept_keywords.initialize(&m_package_accept_keywords, m_portagesettings->m_raised_arch);
+	return m_changed;
 }
 
 /** Cycle through profile and put path to files into this->m_profile_files. */
@@ -22,6 +22,7 @@
 class Package;
 class PortageSettings;
 class ProfileFilenames;
+class ProfileSnapshot;
 
 class ProfileFile {
 		std::string filename;
@@ -54,6 +55,9 @@ class CascadingProfile {
 		bool m_init_world;
 		typedef std::vector<ProfileFile> ProfileFiles;
 		ProfileFiles m_profile_files; /**< List of files in profile. */
+		ProfileFiles m_read_files; /**< Files to be read by finalize() */
+		ProfileFiles::size_type m_changes_from; /**< First file of m_read_files relevant for the return value of finalize() */
+		bool m_changed;
 		PortageSettings *m_portagesettings; /**< Profilesettings to which this instance "belongs" */
 
 		MaskList<Mask> m_system;         /**< Packages in @system */
@@ -72,6 +76,15 @@ class CascadingProfile {
 			return addProfile(profile, NULLPTR);
 		}
 
+		/** Key under which the data of m_read_files is stored in a snapshot */
+		std::string snapshotKey();
+
+		/** Append the PreLists and m_changed to out */
+		void serialize(std::string *out) ATTRIBUTE_NONNULL_;
+
+		/** Restore the PreLists and m_changed from data of serialize() */
+		bool restore(const std::string& data);
+
 		/** Handler functions follow for reading a file */
 		typedef bool (CascadingProfile::*Handler)(const std::string& filename, const char *repo);
 
@@ -105,21 +118,33 @@ class CascadingProfile {
 			print_profile_paths(false),
 			use_world(false), finalized(false),
 			m_init_world(init_world),
+			m_changes_from(0), m_changed(false),
 			m_portagesettings(portagesettings) {
 		}
 
-		/** Populate MaskLists from PreLists.
-		    All files must have been read and m_raised_arch
-		    must be known when this is called. */
-		void finalize();
+		/** Read the queued files (or take their data from snapshot),
+		    and populate MaskLists from PreLists.
+		    All files must have been queued and m_raised_arch
+		    must be known when this is called.
+		 * @return true if at least one file since markChanges() changed data. */
+		bool finalize(ProfileSnapshot *snapshot) ATTRIBUTE_NONNULL_;
 
 		/** Read all "make.defaults" files previously added by listadd... */
 		void readMakeDefaults();
 
-		/** Read all mask/system files previously added by listadd...
-		 * and clear this list of files afterwards.
-		 * @return true if at least one file changed data. */
-		bool readremoveFiles();
+		/** Queue all mask/system files previously added by listadd...
+		 * for reading and clear this list of files afterwards. */
+		void queueFiles();
+
+		/** Read the queued files now. */
+		void readFiles();
+
+		/** Only files queued from now on are relevant for
+		 * the return value of finalize() */
+		void markChanges() {
+			m_changes_from = m_read_files.size();
+			m_changed = false;
+		}
 
 		/** Cycle through profile and put path to files into
 		 * m_profile_files. */
@@ -27,6 +27,7 @@
 #include "eixTk/i18n.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/snapshot.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
 #include "eixTk/sysutils.h"
@@ -36,6 +37,7 @@
 #include "portage/basicversion.h"
 #include "portage/conf/cascadingprofile.h"
 #include "portage/conf/portagesettings.h"
+#include "portage/conf/profilesnapshot.h"
 #include "portage/keywords.h"
 #include "portage/mask.h"
 #include "portage/mask_list.h"
@@ -333,26 +335,28 @@ void PortageSettings::init(EixRc *eixrc, bool getlocal, bool init_world, bool pr
 	if(unlikely(print_profile_paths)) {
 		return;
 	}
+	ProfileSnapshot snapshot((*eixrc)["PROFILE_CACHE"]);
 	profile->readMakeDefaults();
-	profile->readremoveFiles();
+	profile->queueFiles();
+	if(!snapshot.enabled()) {
+		// Without snapshot, read the files common to local_profile only once
+		profile->readFiles();
+	}
 	CascadingProfile *local_profile(NULLPTR);
 	if(getlocal) {
 		local_profile = new CascadingProfile(*profile);
+		local_profile->markChanges();
 	}
 	addOverlayProfiles(profile);
 	if(getlocal) {
 		local_profile->listaddProfile((m_eprefixconf + USER_PROFILE_DIR).c_str());
 		addOverlayProfiles(local_profile);
 		local_profile->readMakeDefaults();
-		if(!local_profile->readremoveFiles()) {
-			// local_profile does not differ; we do not need it
-			delete local_profile;
-			local_profile = NULLPTR;
-		}
-		profile->readremoveFiles();
+		local_profile->queueFiles();
+		profile->queueFiles();
 	} else {
 		profile->readMakeDefaults();
-		profile->readremoveFiles();
+		profile->queueFiles();
 	} {
 		const char *useflags(cstr("USE"));
 		if(likely(useflags != NULLPTR)) {
@@ -408,13 +412,16 @@ void PortageSettings::init(EixRc *eixrc, bool getlocal, bool init_world, bool pr
 	}
 
 	// Finalize global and local cascading profile and create user_config
-	profile->finalize();
+	profile->finalize(&snapshot);
 	if(getlocal) {
-		if(local_profile != NULLPTR) {
-			local_profile->finalize();
+		if(!local_profile->finalize(&snapshot)) {
+			// local_profile does not differ; we do not need it
+			delete local_profile;
+			local_profile = NULLPTR;
 		}
-		user_config = new PortageUserConfig(this, local_profile);
+		user_config = new PortageUserConfig(this, local_profile, &snapshot);
 	}
+	snapshot.flush();
 
 	WordVec sets_dirs;
 	split_string(&sets_dirs, (*eixrc)["EIX_LOCAL_SETS"], true);
@@ -710,11 +717,11 @@ void PortageSettings::addOverlayProfiles(CascadingProfile *p) const {
 	}
 }
 
-PortageUserConfig::PortageUserConfig(PortageSettings *psettings, CascadingProfile *local_profile) {
+PortageUserConfig::PortageUserConfig(PortageSettings *psettings, CascadingProfile *local_profile, ProfileSnapshot *snapshot) {
 	m_settings = psettings;
 	profile    = local_profile;
 	read_use = read_env = read_license = read_restrict = read_cflags = false;
-	readKeywords();
+	readKeywords(snapshot);
 	readMasks();
 }
 
@@ -731,19 +738,53 @@ bool PortageUserConfig::readMasks() {
 	return added;
 }
 
-bool PortageUserConfig::readKeywords() {
+static bool restore_keywords(PreList *pre_list, bool *added, const string& data) ATTRIBUTE_NONNULL_;
+
+static bool restore_keywords(PreList *pre_list, bool *added, const string& data) {
+	SnapshotReader reader(data.c_str(), data.c_str() + data.size());
+	WordVec::size_type restored;
+	if(unlikely(!reader.get_number(&restored))) {
+		return false;
+	}
+	if(unlikely(!(pre_list->restore(&reader) && reader.at_end()))) {
+		*pre_list = PreList();
+		return false;
+	}
+	*added = (restored != 0);
+	return true;
+}
+
+bool PortageUserConfig::readKeywords(ProfileSnapshot *snapshot) {
 	PreList pre_list;
 	bool added(false);
-	LineVec lines;
 	const string& path(m_settings->m_eprefixconf);
-	string file(path + USER_KEYWORDS_FILE1);
-	if(pushback_lines(file.c_str(), &lines, true, true)) {
-		added = pre_list.handle_file(lines, file, NULLPTR, true);
-		lines.clear();
-	}
-	file = (path + USER_KEYWORDS_FILE2);
-	if(pushback_lines(file.c_str(), &lines, true, true)) {
-		added |= pre_list.handle_file(lines, file, NULLPTR,  true);
+	string file1(path + USER_KEYWORDS_FILE1);
+	string file2(path + USER_KEYWORDS_FILE2);
+	string key;
+	const string *data(NULLPTR);
+	if(snapshot->enabled()) {
+		snapshot_add_string(&key, "keywords");
+		snapshot_add_string(&key, file1);
+		snapshot_add_stamp(&key, file1.c_str(), true);
+		snapshot_add_string(&key, file2);
+		snapshot_add_stamp(&key, file2.c_str(), true);
+		data = snapshot->find(key);
+	}
+	if((data == NULLPTR) || unlikely(!restore_keywords(&pre_list, &added, *data))) {
+		LineVec lines;
+		if(pushback_lines(file1.c_str(), &lines, true, true)) {
+			added = pre_list.handle_file(lines, file1, NULLPTR, true);
+			lines.clear();
+		}
+		if(pushback_lines(file2.c_str(), &lines, true, true)) {
+			added |= pre_list.handle_file(lines, file2, NULLPTR,  true);
+		}
+		if(!key.empty()) {
+			string out;
+			snapshot_add_number(&out, (added ? 1 : 0));
+			pre_list.serialize(&out);
+			snapshot->store(key, out);
+		}
 	}
 	if(!added) {
 		return false;
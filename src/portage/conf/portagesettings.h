@@ -24,6 +24,7 @@
 
 class CascadingProfile;
 class EixRc;
+class ProfileSnapshot;
 class Version;
 
 /* Files for categories the user defined and categories from the official tree */
@@ -62,7 +63,7 @@ class PortageUserConfig {
 
 		/** return true if something was added */
 		bool readMasks();
-		bool readKeywords();
+		bool readKeywords(ProfileSnapshot *snapshot) ATTRIBUTE_NONNULL_;
 
 		bool CheckList(Package *p, const MaskList<KeywordMask> *list, Keywords::Redundant flag_double, Keywords::Redundant flag_in) const ATTRIBUTE_NONNULL_;
 		bool CheckFile(Package *p, const char *file, MaskList<KeywordMask> *list, bool *readfile, Keywords::Redundant flag_double, Keywords::Redundant flag_in) const ATTRIBUTE_NONNULL_;
@@ -71,7 +72,7 @@ class PortageUserConfig {
 		void pushback_set_accepted_keywords(WordVec *result, const Version *v) const ATTRIBUTE_NONNULL_;
 
 	public:
-		PortageUserConfig(PortageSettings *psettings, CascadingProfile *local_profile) ATTRIBUTE_NONNULL_;
+		PortageUserConfig(PortageSettings *psettings, CascadingProfile *local_profile, ProfileSnapshot *snapshot) ATTRIBUTE_NONNULL((2, 4));
 
 		~PortageUserConfig();
 
@@ -0,0 +1,155 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#include <config.h>
+
+#include <cstring>
+
+#include <string>
+#include <utility>
+
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/snapshot.h"
+#include "eixTk/stringtypes.h"
+#include "portage/conf/profilesnapshot.h"
+
+using std::make_pair;
+using std::string;
+
+#define PROFILE_SNAPSHOT_MAGIC "eix-profile-snapshot 1 " PACKAGE_VERSION
+
+/// Entries not used in the current run are kept only up to this total
+#define PROFILE_SNAPSHOT_MAX 8
+
+/**
+The file is a snapshot (see eixTk/snapshot.h) with the entries:
+magic, number of entries, and for each entry
+the length of the key, the key, the length of the data, and the data.
+Keys and data may contain \0 and are thus stored with their length.
+**/
+
+static bool get_raw(SnapshotReader *reader, string *s) ATTRIBUTE_NONNULL_;
+
+static bool get_raw(SnapshotReader *reader, string *s) {
+	WordVec::size_type length;
+	if(unlikely(!reader->get_number(&length))) {
+		return false;
+	}
+	const char *data(reader->skip(length));
+	if(unlikely(data == NULLPTR)) {
+		return false;
+	}
+	s->assign(data, length);
+	return true;
+}
+
+static void add_raw(string *out, const string& s) ATTRIBUTE_NONNULL_;
+
+static void add_raw(string *out, const string& s) {
+	snapshot_add_number(out, s.size());
+	out->append(s);
+}
+
+void ProfileSnapshot::load() {
+	loaded = true;
+	string content;
+	if(!snapshot_read(m_file.c_str(), &content)) {
+		return;
+	}
+	SnapshotReader reader(content.c_str(), content.c_str() + content.size());
+	const char *magic(reader.get());
+	if(unlikely((magic == NULLPTR) || (strcmp(magic, PROFILE_SNAPSHOT_MAGIC) != 0))) {
+		return;
+	}
+	WordVec::size_type count;
+	if(unlikely(!reader.get_number(&count))) {
+		return;
+	}
+	for(; likely(count != 0); --count) {
+		string key, data;
+		if(unlikely((!get_raw(&reader, &key)) || (!get_raw(&reader, &data)))) {
+			return;
+		}
+		if(likely(index.insert(make_pair(key, entries.size())).second)) {
+			entries.push_back(Entry(key, data, false));
+		}
+	}
+}
+
+const string *ProfileSnapshot::find(const string& key) {
+	if(!enabled()) {
+		return NULLPTR;
+	}
+	if(!loaded) {
+		load();
+	}
+	Index::const_iterator it(index.find(key));
+	if(it == index.end()) {
+		return NULLPTR;
+	}
+	Entry& entry(entries[it->second]);
+	entry.used = true;
+	return &(entry.data);
+}
+
+void ProfileSnapshot::store(const string& key, const string& data) {
+	if(!enabled()) {
+		return;
+	}
+	if(!loaded) {
+		load();
+	}
+	dirty = true;
+	Index::const_iterator it(index.find(key));
+	if(it != index.end()) {
+		Entry& entry(entries[it->second]);
+		entry.data = data;
+		entry.used = true;
+		return;
+	}
+	index.insert(make_pair(key, entries.size()));
+	entries.push_back(Entry(key, data, true));
+}
+
+void ProfileSnapshot::flush() {
+	if(!dirty) {
+		return;
+	}
+	dirty = false;
+	// Entries of the current run come first; older ones fill up the rest
+	WordVec::size_type count(0);
+	for(Entries::const_iterator it(entries.begin()); likely(it != entries.end()); ++it) {
+		if(it->used) {
+			++count;
+		}
+	}
+	WordVec::size_type old(0);
+	if(count < PROFILE_SNAPSHOT_MAX) {
+		old = PROFILE_SNAPSHOT_MAX - count;
+		if(old > entries.size() - count) {
+			old = entries.size() - count;
+		}
+	}
+	string out;
+	snapshot_add_string(&out, PROFILE_SNAPSHOT_MAGIC);
+	snapshot_add_number(&out, count + old);
+	for(Entries::const_iterator it(entries.begin()); likely(it != entries.end()); ++it) {
+		if(it->used) {
+			add_raw(&out, it->key);
+			add_raw(&out, it->data);
+		}
+	}
+	for(Entries::const_iterator it(entries.begin()); likely(old != 0); ++it) {
+		if(!it->used) {
+			add_raw(&out, it->key);
+			add_raw(&out, it->data);
+			--old;
+		}
+	}
+	snapshot_write(m_file, out);
+}
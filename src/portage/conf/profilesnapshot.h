@@ -0,0 +1,62 @@
+// vim:set noet cinoptions= sw=4 ts=4:
+// This file is part of the eix project and distributed under the
+// terms of the GNU General Public License v2.
+//
+// Copyright (c)
+//   Martin Väth <martin@mvath.de>
+
+#ifndef SRC_PORTAGE_CONF_PROFILESNAPSHOT_H_
+#define SRC_PORTAGE_CONF_PROFILESNAPSHOT_H_ 1
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eixTk/null.h"
+
+/** Snapshot of the parsed profile and user config (PROFILE_CACHE).
+ * The data is stored under keys which contain the stamps of all files
+ * from which it was read, so outdated data is simply never found. */
+class ProfileSnapshot {
+	public:
+		/// An empty filename disables the snapshot
+		explicit ProfileSnapshot(const std::string& file) : m_file(file), loaded(false), dirty(false) {
+		}
+
+		~ProfileSnapshot() {
+			flush();
+		}
+
+		bool enabled() const {
+			return !m_file.empty();
+		}
+
+		/// @return NULLPTR if there is no data for key
+		const std::string *find(const std::string& key);
+
+		void store(const std::string& key, const std::string& data);
+
+		/// Write the file if something was stored
+		void flush();
+
+	private:
+		class Entry {
+			public:
+				std::string key, data;
+				bool used;
+
+				Entry(const std::string& k, const std::string& d, bool u) : key(k), data(d), used(u) {
+				}
+		};
+		typedef std::vector<Entry> Entries;
+		typedef std::map<std::string, Entries::size_type> Index;
+
+		std::string m_file;
+		bool loaded, dirty;
+		Entries entries;
+		Index index;
+
+		void load();
+};
+
+#endif  // SRC_PORTAGE_CONF_PROFILESNAPSHOT_H_
@@ -7,13 +7,19 @@
 
 #include <config.h>
 
+#include <cstdlib>
+
+#include <iostream>
 #include <string>
 
+#include "database/io.h"
 #include "eixTk/constexpr.h"
 #include "eixTk/likely.h"
 #include "eixTk/stringutils.h"
 #include "portage/depend.h"
 
+using std::cerr;
+using std::endl;
 using std::string;
 
 bool Depend::use_depend;
@@ -58,6 +64,7 @@ void Depend::set(const string& depend, const string& rdepend, const string& pdep
 	m_rdepend = rdepend;
 	m_pdepend = pdepend;
 	m_hdepend = hdepend;
+	m_lazy_db = NULLPTR;
 	if(normspace) {
 		trimall(&m_depend);
 		trimall(&m_rdepend);
@@ -69,6 +76,16 @@ void Depend::set(const string& depend, const string& rdepend, const string& pdep
 	obsolete = false;
 }
 
+void Depend::load_lazy() const {
+	Database *db(m_lazy_db);
+	m_lazy_db = NULLPTR;
+	string errtext;
+	if(unlikely(!db->read_depend_lazy(*this, *m_lazy_header, m_lazy_offset, &errtext))) {
+		cerr << errtext << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
 string Depend::subst(const string& in, const string& text, bool obs) {
 	string::size_type pos(in.find(the_same));
 	if(pos == string::npos) {
@@ -10,6 +10,10 @@
 
 #include <string>
 
+#include "eixTk/eixint.h"
+#include "eixTk/likely.h"
+#include "eixTk/null.h"
+
 class Database;
 class DBHeader;
 class Version;
@@ -19,8 +23,21 @@ class Depend {
 	friend class Database;
 
 	private:
-		std::string m_depend, m_rdepend, m_pdepend, m_hdepend;
-		bool obsolete;
+		mutable std::string m_depend, m_rdepend, m_pdepend, m_hdepend;
+		mutable bool obsolete;
+
+		/// If nonzero, the data still has to be read from this database
+		mutable Database *m_lazy_db;
+		eix::OffsetType m_lazy_offset;
+		const DBHeader *m_lazy_header;
+
+		void load() const {
+			if(unlikely(m_lazy_db != NULLPTR)) {
+				load_lazy();
+			}
+		}
+
+		void load_lazy() const;
 
 		static const char c_depend[];
 		static const char c_rdepend[];
@@ -30,60 +47,73 @@ class Depend {
 	public:
 		static bool use_depend;
 
-		Depend() : obsolete(false) {
+		Depend() : obsolete(false), m_lazy_db(NULLPTR) {
 		}
 
 		void set(const std::string& depend, const std::string& rdepend, const std::string& pdepend, const std::string& hdepend, bool normspace);
 
 		std::string get_depend() const {
+			load();
 			return subst(m_depend, m_rdepend, obsolete);
 		}
 
 		std::string get_depend_brief() const {
+			load();
 			return subst(m_depend, c_rdepend, obsolete);
 		}
 
 		std::string get_rdepend() const {
+			load();
 			return subst(m_rdepend, m_depend, obsolete);
 		}
 
 		std::string get_rdepend_brief() const {
+			load();
 			return subst(m_rdepend, c_depend, obsolete);
 		}
 
 		std::string get_pdepend() const {
+			load();
 			return m_pdepend;
 		}
 
 		std::string get_pdepend_brief() const {
+			load();
 			return m_pdepend;
 		}
 
 		std::string get_hdepend() const {
+			load();
 			return m_hdepend;
 		}
 
 		std::string get_hdepend_brief() const {
+			load();
 			return m_hdepend;
 		}
 
 		bool depend_empty() const {
+			load();
 			return m_depend.empty();
 		}
 
 		bool rdepend_empty() const {
+			load();
 			return m_rdepend.empty();
 		}
 
 		bool pdepend_empty() const {
+			load();
 			return m_pdepend.empty();
 		}
 
 		bool hdepend_empty() const {
+			load();
 			return m_hdepend.empty();
 		}
 
 		bool empty() const {
+			load();
 			return (m_depend.empty() && m_rdepend.empty() && m_pdepend.empty() && m_hdepend.empty());
 		}
 
@@ -93,6 +123,7 @@ class Depend {
 			m_pdepend.clear();
 			m_hdepend.clear();
 			obsolete = false;
+			m_lazy_db = NULLPTR;
 		}
 
 		bool operator==(const Depend& d) const;
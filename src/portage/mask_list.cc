@@ -15,6 +15,7 @@
 #include "eixTk/exceptions.h"
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/snapshot.h"
 #include "eixTk/stringlist.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
@@ -327,6 +328,93 @@ void PreList::finalize() {
 	have.clear();
 }
 
+void PreList::serialize(string *out) {
+	finalize();
+	snapshot_add_number(out, filenames.size());
+	for(FileNames::const_iterator it(filenames.begin());
+		likely(it != filenames.end()); ++it) {
+		snapshot_add_string(out, it->name());
+		const char *r(it->repo());
+		if(r == NULLPTR) {
+			snapshot_add_string(out, "-");
+		} else {
+			snapshot_add_string(out, "+");
+			snapshot_add_string(out, r);
+		}
+	}
+	snapshot_add_number(out, size());
+	for(const_iterator it(begin()); likely(it != end()); ++it) {
+		snapshot_add_string(out, it->name);
+		snapshot_add_number(out, it->args.size());
+		for(WordVec::const_iterator a(it->args.begin());
+			likely(a != it->args.end()); ++a) {
+			snapshot_add_string(out, *a);
+		}
+		snapshot_add_number(out, it->filename_index);
+		snapshot_add_number(out, it->linenumber);
+		snapshot_add_number(out, (it->locally_double ? 1 : 0));
+	}
+}
+
+bool PreList::restore(SnapshotReader *in) {
+	clear();
+	if(likely(restore_entries(in))) {
+		return true;
+	}
+	filenames.clear();
+	super::clear();
+	finalized = false;
+	return false;
+}
+
+bool PreList::restore_entries(SnapshotReader *in) {
+	WordVec::size_type count;
+	if(unlikely(!in->get_number(&count))) {
+		return false;
+	}
+	for(; likely(count != 0); --count) {
+		const char *name(in->get());
+		const char *know_repo(in->get());
+		if(unlikely(know_repo == NULLPTR)) {
+			return false;
+		}
+		const char *r(NULLPTR);
+		if(*know_repo == '+') {
+			r = in->get();
+			if(unlikely(r == NULLPTR)) {
+				return false;
+			}
+		}
+		push_name(name, r);
+	}
+	if(unlikely(!in->get_number(&count))) {
+		return false;
+	}
+	super::reserve(count);
+	for(; likely(count != 0); --count) {
+		push_back(PreListEntry());
+		PreListEntry& e(back());
+		WordVec::size_type args, locally_double;
+		if(unlikely((!in->get(&e.name)) || (!in->get_number(&args)))) {
+			return false;
+		}
+		for(; likely(args != 0); --args) {
+			e.args.push_back(string());
+			if(unlikely(!in->get(&e.args.back()))) {
+				return false;
+			}
+		}
+		if(unlikely((!in->get_number(&e.filename_index)) ||
+			(!in->get_number(&e.linenumber)) ||
+			(!in->get_number(&locally_double)) ||
+			(e.filename_index >= filenames.size()))) {
+			return false;
+		}
+		e.locally_double = (locally_double != 0);
+	}
+	return true;
+}
+
 void PreList::initialize(MaskList<Mask> *l, Mask::Type t, bool keep_commentlines) {
 	finalize();
 	StringList *comments(NULLPTR);
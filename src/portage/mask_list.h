@@ -12,6 +12,9 @@
 
 #include <fnmatch.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <list>
 #include <map>
 #include <string>
@@ -28,6 +31,7 @@
 #include "portage/package.h"
 
 class Package;
+class SnapshotReader;
 class Version;
 
 template<typename m_Type> class Masks : public std::list<m_Type> {
@@ -75,6 +79,55 @@ template<typename m_Type> class MaskList : std::vector<Masks<m_Type> > {
 		LookupType exact_name;
 		MapType full_index;
 
+		// The patterns are indexed by their category if it is literal,
+		// otherwise by their name if that is literal.
+		// Each Indizes is sorted, since patterns are only appended.
+		typedef typename std::vector<size_type> Indizes;
+		typedef typename std::map<std::string, Indizes> PatternIndex;
+		typedef typename PatternIndex::const_iterator pattern_const_iterator;
+		typedef typename Indizes::const_iterator indizes_const_iterator;
+		PatternIndex category_index, name_index;
+		Indizes other_patterns;
+
+		static bool is_literal(const char *s) ATTRIBUTE_NONNULL_ {
+			return (std::strpbrk(s, "*?[\\") == NULLPTR);
+		}
+
+		static const Indizes *find_index(const PatternIndex& index, const std::string& key) {
+			pattern_const_iterator it(index.find(key));
+			return ((it == index.end()) ? NULLPTR : &(it->second));
+		}
+
+		/// @return the (sorted) indizes of the patterns which can match full
+		const Indizes *candidates(Indizes *merged, const std::string& full) const ATTRIBUTE_NONNULL_ {
+			std::string::size_type slash(full.find('/'));
+			const Indizes *by_category(find_index(category_index, full.substr(0, slash)));
+			const Indizes *by_name(NULLPTR);
+			if(likely(slash != std::string::npos)) {
+				by_name = find_index(name_index, full.substr(slash + 1));
+			}
+			// Shortcut for the most frequent case that only one list is relevant
+			if(by_category == NULLPTR) {
+				if(by_name == NULLPTR) {
+					return &other_patterns;
+				}
+				if(likely(other_patterns.empty())) {
+					return by_name;
+				}
+			} else if(likely((by_name == NULLPTR) && other_patterns.empty())) {
+				return by_category;
+			}
+			if(by_category != NULLPTR) {
+				merged->insert(merged->end(), by_category->begin(), by_category->end());
+			}
+			if(by_name != NULLPTR) {
+				merged->insert(merged->end(), by_name->begin(), by_name->end());
+			}
+			merged->insert(merged->end(), other_patterns.begin(), other_patterns.end());
+			std::sort(merged->begin(), merged->end());
+			return merged;
+		}
+
 	public:
 		typedef typename eix::ptr_list<const m_Type> Get;
 
@@ -86,14 +139,22 @@ template<typename m_Type> class MaskList : std::vector<Masks<m_Type> > {
 			super::clear();
 			exact_name.clear();
 			full_index.clear();
+			category_index.clear();
+			name_index.clear();
+			other_patterns.clear();
 		}
 
 		bool match_full(const std::string& full) const {
 			if(exact_name.find(full) != exact_name.end()) {
 				return true;
 			}
-			for(const_iterator it(begin()); likely(it != end()); ++it) {
-				if(unlikely(it->match_full(full.c_str()))) {
+			if(likely(super::empty())) {
+				return false;
+			}
+			Indizes merged;
+			const Indizes *indizes(candidates(&merged, full));
+			for(indizes_const_iterator it(indizes->begin()); likely(it != indizes->end()); ++it) {
+				if(unlikely((*this)[*it].match_full(full.c_str()))) {
 					return true;
 				}
 			}
@@ -115,9 +176,14 @@ template<typename m_Type> class MaskList : std::vector<Masks<m_Type> > {
 
 		Get *get_full(const std::string& full) const {
 			Get *l(NULLPTR);
-			for(const_iterator it(begin()); likely(it != end()); ++it) {
-				if(unlikely(it->match_full(full.c_str()))) {
-					push_result(&l, *it);
+			if(unlikely(!super::empty())) {
+				Indizes merged;
+				const Indizes *indizes(candidates(&merged, full));
+				for(indizes_const_iterator it(indizes->begin()); likely(it != indizes->end()); ++it) {
+					const Masks<m_Type>& masks((*this)[*it]);
+					if(unlikely(masks.match_full(full.c_str()))) {
+						push_result(&l, masks);
+					}
 				}
 			}
 			lookup_const_iterator it(exact_name.find(full));
@@ -153,8 +219,16 @@ template<typename m_Type> class MaskList : std::vector<Masks<m_Type> > {
 				(*this)[f->second].add(m);
 				return;
 			}
-			full_index.insert(std::pair<std::string, size_type>(full, size()));
+			size_type index(size());
+			full_index.insert(std::pair<std::string, size_type>(full, index));
 			push_back(Masks<m_Type>(full, m));
+			if(is_literal(m.getCategory())) {
+				category_index[m.getCategory()].push_back(index);
+			} else if(is_literal(m.getName())) {
+				name_index[m.getName()].push_back(index);
+			} else {
+				other_patterns.push_back(index);
+			}
 		}
 
 		/* return true if something was added */
@@ -291,6 +365,8 @@ class PreList : public std::vector<PreListEntry> {
 		Have have;
 		bool finalized;
 
+		bool restore_entries(SnapshotReader *in) ATTRIBUTE_NONNULL_;
+
 	public:
 		void clear() {
 			finalize();
@@ -349,6 +425,13 @@ class PreList : public std::vector<PreListEntry> {
 
 		void finalize();
 
+		/// Finalize and append the result to a snapshot
+		void serialize(std::string *out) ATTRIBUTE_NONNULL_;
+
+		/// Replace the content by the finalized result of a snapshot
+		/// @return false if the snapshot is broken
+		bool restore(SnapshotReader *in) ATTRIBUTE_NONNULL_;
+
 		void initialize(MaskList<Mask> *l, Mask::Type t, bool keep_commentlines) ATTRIBUTE_NONNULL_;
 		void initialize(MaskList<Mask> *l, Mask::Type t) ATTRIBUTE_NONNULL_ {
 			initialize(l, t, false);
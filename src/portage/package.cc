@@ -9,13 +9,35 @@
 
 #include <config.h>
 
+#include <cstddef>
+
 #include "eixTk/likely.h"
+#include "eixTk/null.h"
+#include "eixTk/objectpool.h"
 #include "portage/basicversion.h"
 #include "portage/extendedversion.h"
 #include "portage/keywords.h"
 #include "portage/package.h"
 #include "portage/version.h"
 
+static eix::ObjectPool *package_pool = NULLPTR;
+
+void *Package::operator new(size_t size) {
+	if(unlikely(package_pool == NULLPTR)) {
+		package_pool = new eix::ObjectPool(sizeof(Package));
+	}
+	return package_pool->allocate(size);
+}
+
+void Package::operator delete(void *p, size_t size) {
+	// delete of a NULLPTR may call this before anything was allocated
+	if(likely(package_pool != NULLPTR)) {
+		package_pool->deallocate(p, size);
+	} else {
+		::operator delete(p);
+	}
+}
+
 Package::~Package() {
 	delete_and_clear();
 }
@@ -10,6 +10,8 @@
 #ifndef SRC_PORTAGE_PACKAGE_H_
 #define SRC_PORTAGE_PACKAGE_H_ 1
 
+#include <cstddef>
+
 #include <list>
 #include <map>
 #include <string>
@@ -105,7 +107,7 @@ class Package : public eix::ptr_list<Version> {
 
 		MaskFlags local_collects;
 
-		std::vector<MaskFlags> saved_collects;
+		MaskFlags saved_collects[Version::SAVEMASK_SIZE];
 
 		/** Package properties (stored in db) */
 		std::string category, name, desc, homepage, licenses;
@@ -166,19 +168,22 @@ class Package : public eix::ptr_list<Version> {
 		}
 
 		/// Preset with defaults
-		Package() : saved_collects(Version::SAVEMASK_SIZE, MaskFlags(MaskFlags::MASK_NONE)) {
+		Package() {
 			defaults();
 		}
 
 		/// Fill in name and category and preset with defaults
-		Package(const std::string& c, const std::string& n) :
-			saved_collects(Version::SAVEMASK_SIZE, MaskFlags(MaskFlags::MASK_NONE)), category(c), name(n) {
+		Package(const std::string& c, const std::string& n) : category(c), name(n) {
 			defaults();
 		}
 
 		/** De-constructor, delete content of Version-list. */
 		~Package();
 
+		/// Packages are allocated from a pool, see eixTk/objectpool.h
+		static void *operator new(size_t size);
+		static void operator delete(void *p, size_t size);
+
 		/** Adds a version to "the versions" list.
 		    Only BasicVersion needs to be filled here.
 		    You must call addVersionFinalize() after filling
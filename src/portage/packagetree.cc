@@ -23,23 +23,40 @@ using std::pair;
 using std::string;
 
 Category::iterator Category::find(const std::string& pkg_name) {
-	iterator i(begin());
-	for(; likely(i != end()); ++i) {
-		if(unlikely(i->name == pkg_name)) {
-			return i;
-		}
+	NameIndex::const_iterator i(name_index.find(pkg_name));
+	if(i == name_index.end()) {
+		return iterator(end());
 	}
-	return i;
+	return iterator(i->second);
 }
 
 Category::const_iterator Category::find(const std::string& pkg_name) const {
-	const_iterator i(begin());
-	for(; likely(i != end()); ++i) {
-		if(unlikely(i->name == pkg_name)) {
-			return i;
-		}
+	NameIndex::const_iterator i(name_index.find(pkg_name));
+	if(i == name_index.end()) {
+		return const_iterator(end());
 	}
-	return i;
+	return const_iterator(List::const_iterator(i->second));
+}
+
+void Category::push_back(Package *pkg) {
+	List::push_back(pkg);
+	// If a name occurs twice, find() returns the first one
+	name_index.insert(NameIndex::value_type(pkg->name, --List::end()));
+}
+
+Category::iterator Category::erase(iterator it) {
+	NameIndex::iterator i(name_index.find(it->name));
+	if(likely((i != name_index.end()) && (i->second == it))) {
+		name_index.erase(i);
+	}
+	return iterator(List::erase(it));
+}
+
+Category::iterator Category::delete_package(iterator it) {
+	Package *pkg(*it);
+	iterator next(erase(it));
+	delete pkg;
+	return next;
 }
 
 #if 0
@@ -48,8 +65,7 @@ bool Category::deletePackage(const std::string& pkg_name) {
 	if(i == end()) {
 		return false;
 	}
-	delete *i;
-	erase(i);
+	delete_package(i);
 	return true;
 }
 #endif
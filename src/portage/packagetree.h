@@ -10,6 +10,7 @@
 #ifndef SRC_PORTAGE_PACKAGETREE_H_
 #define SRC_PORTAGE_PACKAGETREE_H_ 1
 
+#include <list>
 #include <map>
 #include <string>
 
@@ -20,7 +21,17 @@
 
 class Package;
 
+/// The packages of a category in the order in which they were added.
+// Packages must only be added or removed through the methods of Category
+// (not of the base classes) so that the name index is kept up to date.
 class Category : public eix::ptr_list<Package> {
+	private:
+		typedef std::list<Package*> List;
+		typedef std::map<std::string, List::iterator> NameIndex;
+
+		/// The position of each package in the list
+		NameIndex name_index;
+
 	public:
 		Category() {
 		}
@@ -37,11 +48,29 @@ class Category : public eix::ptr_list<Package> {
 			return ((i == end()) ? NULLPTR : (*i));
 		}
 
+		void push_back(Package *pkg) ATTRIBUTE_NONNULL_;
+
 		void addPackage(Package *pkg) ATTRIBUTE_NONNULL_ {
 			push_back(pkg);
 		}
 
 		Package *addPackage(const std::string cat_name, const std::string& pkg_name);
+
+		/// The package is used to update the index, so it must not yet be deleted
+		iterator erase(iterator it);
+
+		/// Remove the package and delete it (in this order)
+		iterator delete_package(iterator it);
+
+		void clear() {
+			name_index.clear();
+			List::clear();
+		}
+
+		void delete_and_clear() {
+			eix::delete_all(begin(), end());
+			clear();
+		}
 };
 
 class PackageTree : public std::map<std::string, Category*> {
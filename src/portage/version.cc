@@ -9,10 +9,13 @@
 
 #include <config.h>
 
+#include <cstddef>
+
 #include <string>
 
 #include "eixTk/likely.h"
 #include "eixTk/null.h"
+#include "eixTk/objectpool.h"
 #include "eixTk/stringlist.h"
 #include "eixTk/stringtypes.h"
 #include "eixTk/stringutils.h"
@@ -20,6 +23,24 @@
 
 using std::string;
 
+static eix::ObjectPool *version_pool = NULLPTR;
+
+void *Version::operator new(size_t size) {
+	if(unlikely(version_pool == NULLPTR)) {
+		version_pool = new eix::ObjectPool(sizeof(Version));
+	}
+	return version_pool->allocate(size);
+}
+
+void Version::operator delete(void *p, size_t size) {
+	// delete of a NULLPTR may call this before anything was allocated
+	if(likely(version_pool != NULLPTR)) {
+		version_pool->deallocate(p, size);
+	} else {
+		::operator delete(p);
+	}
+}
+
 const IUse::Flags
 	IUse::USEFLAGS_NIL,
 	IUse::USEFLAGS_NORMAL,
@@ -101,6 +122,7 @@ string IUse::asString() const {
 }
 
 string IUseSet::asString() const {
+	load();
 	string ret;
 	for(IUseStd::const_iterator it(m_iuse.begin());
 		likely(it != m_iuse.end()); ++it) {
@@ -112,6 +134,7 @@ string IUseSet::asString() const {
 }
 
 WordVec IUseSet::asVector() const {
+	load();
 	WordVec ret(m_iuse.size());
 	WordVec::size_type i(0);
 	for(IUseStd::const_iterator it(m_iuse.begin());
@@ -124,10 +147,15 @@ WordVec IUseSet::asVector() const {
 void IUseSet::insert(const IUseStd& iuse) {
 	for(IUseStd::const_iterator it(iuse.begin());
 		likely(it != iuse.end()); ++it) {
-		insert(*it);
+		insert(&m_iuse, *it);
 	}
 }
 
+void IUseSet::insert(const IUseSet& iuse) {
+	insert(iuse.m_iuse);
+	m_lazy.insert(m_lazy.end(), iuse.m_lazy.begin(), iuse.m_lazy.end());
+}
+
 void IUseSet::insert(const string& iuse) {
 	WordVec vec;
 	split_string(&vec, iuse);
@@ -137,18 +165,26 @@ void IUseSet::insert(const string& iuse) {
 	}
 }
 
-void IUseSet::insert(const IUse& iuse) {
-	IUseStd::iterator it(m_iuse.find(iuse));
-	if(it == m_iuse.end()) {
-		m_iuse.insert(iuse);
+void IUseSet::insert(IUseStd *s, const IUse& iuse) {
+	IUseStd::iterator it(s->find(iuse));
+	if(it == s->end()) {
+		s->insert(iuse);
 		return;
 	}
 	IUse::Flags oriflags(it->flags);
 	IUse::Flags newflags(oriflags | (iuse.flags));
 	if(newflags == oriflags)
 		return;
-	m_iuse.erase(it);
-	m_iuse.insert(IUse(iuse.name(), newflags));
+	s->erase(it);
+	s->insert(IUse(iuse.name(), newflags));
+}
+
+void IUseSet::load_lazy() const {
+	for(LazyList::const_iterator it(m_lazy.begin());
+		likely(it != m_lazy.end()); ++it) {
+		insert(&m_iuse, IUse(**it));
+	}
+	m_lazy.clear();
 }
 
 const Version::EffectiveState
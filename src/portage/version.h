@@ -10,6 +10,8 @@
 #ifndef SRC_PORTAGE_VERSION_H_
 #define SRC_PORTAGE_VERSION_H_ 1
 
+#include <cstddef>
+
 #include <algorithm>
 #include <set>
 #include <string>
@@ -17,6 +19,7 @@
 
 #include "eixTk/constexpr.h"
 #include "eixTk/eixint.h"
+#include "eixTk/likely.h"
 #include "eixTk/stringlist.h"
 #include "eixTk/stringtypes.h"
 #include "portage/basicversion.h"
@@ -68,28 +71,35 @@ class IUseSet {
 	public:
 		typedef std::set<IUse> IUseStd;
 
+		typedef std::vector<const std::string *> LazyList;
+
 		bool empty() const {
-			return m_iuse.empty();
+			return (m_iuse.empty() && m_lazy.empty());
 		}
 
 		void clear() {
 			m_iuse.clear();
+			m_lazy.clear();
 		}
 
 		const IUseStd& asStd() const {
+			load();
 			return m_iuse;
 		}
 
 		void insert(const IUseStd& iuse);
 
-		void insert(const IUseSet& iuse) {
-			insert(iuse.asStd());
-		}
+		void insert(const IUseSet& iuse);
 
 		void insert(const std::string& iuse);
 
 		void insert_fast(const std::string& iuse) {
-			insert(IUse(iuse));
+			insert(&m_iuse, IUse(iuse));
+		}
+
+		/// Parse iuse only when needed; it must be kept until then
+		void insert_lazy(const std::string *iuse) {
+			m_lazy.push_back(iuse);
 		}
 
 		std::string asString() const;
@@ -97,9 +107,18 @@ class IUseSet {
 		WordVec asVector() const;
 
 	protected:
-		IUseStd m_iuse;
+		mutable IUseStd m_iuse;
+		mutable LazyList m_lazy;
+
+		static void insert(IUseStd *s, const IUse& iuse) ATTRIBUTE_NONNULL_;
 
-		void insert(const IUse& iuse);
+		void load() const {
+			if(unlikely(!m_lazy.empty())) {
+				load_lazy();
+			}
+		}
+
+		void load_lazy() const;
 };
 
 /** Version expands the BasicVersion class by data relevant for versions in tree/overlays.
@@ -129,13 +148,14 @@ class Version : public ExtendedVersion, public Keywords {
 			EFFECTIVE_USED    = 1,
 			EFFECTIVE_UNUSED  = 2;
 
-		std::vector<KeywordsFlags> saved_keywords;
-		std::vector<bool>          have_saved_keywords;
-		std::vector<MaskFlags>     saved_masks;
-		std::vector<bool>          have_saved_masks;
-		std::vector<std::string>   saved_effective;
-		std::vector<std::string>   saved_accepted;
-		std::vector<EffectiveState> states_effective;
+		// Arrays of fixed size: This saves allocations for each version
+		KeywordsFlags  saved_keywords[SAVEKEY_SIZE];
+		bool           have_saved_keywords[SAVEKEY_SIZE];
+		MaskFlags      saved_masks[SAVEMASK_SIZE];
+		bool           have_saved_masks[SAVEMASK_SIZE];
+		std::string    saved_effective[SAVEEFFECTIVE_SIZE];
+		std::string    saved_accepted[SAVEEFFECTIVE_SIZE];
+		EffectiveState states_effective[SAVEEFFECTIVE_SIZE];
 
 		typedef std::vector<SetsIndex> SetsIndizes;
 		SetsIndizes sets_indizes;
@@ -144,15 +164,18 @@ class Version : public ExtendedVersion, public Keywords {
 
 		IUseSet iuse;
 
-		Version() :
-			saved_keywords(SAVEKEY_SIZE, KeywordsFlags()),
-			have_saved_keywords(SAVEKEY_SIZE, false),
-			saved_masks(SAVEMASK_SIZE, MaskFlags()),
-			have_saved_masks(SAVEMASK_SIZE, false),
-			saved_effective(SAVEEFFECTIVE_SIZE, ""),
-			saved_accepted(SAVEEFFECTIVE_SIZE, ""),
-			states_effective(SAVEEFFECTIVE_SIZE, EFFECTIVE_UNSAVED),
-			effective_state(EFFECTIVE_UNUSED) {
+		Version() : effective_state(EFFECTIVE_UNUSED) {
+			std::fill(have_saved_keywords, have_saved_keywords + SAVEKEY_SIZE, false);
+			forget_saved_masks();
+			std::fill(states_effective, states_effective + SAVEEFFECTIVE_SIZE, EFFECTIVE_UNSAVED);
+		}
+
+		/// Versions are allocated from a pool, see eixTk/objectpool.h
+		static void *operator new(size_t size);
+		static void operator delete(void *p, size_t size);
+
+		void forget_saved_masks() {
+			std::fill(have_saved_masks, have_saved_masks + SAVEMASK_SIZE, false);
 		}
 
 		void save_keyflags(SavedKeyIndex i) {
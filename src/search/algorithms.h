@@ -36,6 +36,18 @@ class BaseAlgorithm {
 		}
 
 		virtual bool operator()(const char *s, Package *p) ATTRIBUTE_NONNULL((2)) = 0;
+
+		const std::string& getString() const {
+			return search_string;
+		}
+
+		/** Can the matches be found by a lookup of search_string?
+		 * @param prefix is set if the lookup is for a prefix
+		 * @return false if a lookup is impossible */
+		virtual bool index_lookup(bool *prefix ATTRIBUTE_UNUSED) const ATTRIBUTE_NONNULL_ {
+			UNUSED(prefix);
+			return false;
+		}
 };
 
 /** Use regex to test strings for a match. */
@@ -66,6 +78,11 @@ class RegexAlgorithm : public BaseAlgorithm {
 class ExactAlgorithm : public BaseAlgorithm {
 	public:
 		bool operator()(const char *s, Package *p ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL((2)) ATTRIBUTE_PURE;
+
+		bool index_lookup(bool *prefix) const ATTRIBUTE_NONNULL_ {
+			*prefix = false;
+			return true;
+		}
 };
 
 /** substring matching */
@@ -81,6 +98,11 @@ class SubstringAlgorithm : public BaseAlgorithm {
 class BeginAlgorithm : public BaseAlgorithm {
 	public:
 		bool operator()(const char *s, Package *p ATTRIBUTE_UNUSED) ATTRIBUTE_NONNULL((2)) ATTRIBUTE_PURE;
+
+		bool index_lookup(bool *prefix) const ATTRIBUTE_NONNULL_ {
+			*prefix = true;
+			return true;
+		}
 };
 
 /** end-of-string matching */
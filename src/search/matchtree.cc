@@ -38,6 +38,12 @@ bool MatchAtom::match(PackageReader *p ATTRIBUTE_UNUSED) {
 	return !m_negate;
 }
 
+bool MatchAtom::index_lookup(DBIndex *index ATTRIBUTE_UNUSED, DBIndex::Hits *hits ATTRIBUTE_UNUSED) {
+	UNUSED(index);
+	UNUSED(hits);
+	return false;
+}
+
 MatchAtomOperator::~MatchAtomOperator() {
 	delete m_left;
 	delete m_right;
@@ -74,6 +80,36 @@ bool MatchAtomOperator::match(PackageReader *p) {
 	return is_match;
 }
 
+bool MatchAtomOperator::index_lookup(DBIndex *index, DBIndex::Hits *hits) {
+	if(m_negate || (m_left == NULLPTR) || (m_right == NULLPTR)) {
+		return false;
+	}
+	DBIndex::Hits left, right;
+	bool have_left(m_left->index_lookup(index, &left));
+	bool have_right(m_right->index_lookup(index, &right));
+	if(m_operator == AtomOr) {
+		if(!(have_left && have_right)) {
+			return false;
+		}
+		hits->insert(left.begin(), left.end());
+		hits->insert(right.begin(), right.end());
+		return true;
+	}
+	if(!have_left) {
+		if(!have_right) {
+			return false;
+		}
+		hits->insert(right.begin(), right.end());
+		return true;
+	}
+	for(DBIndex::Hits::const_iterator it(left.begin()); likely(it != left.end()); ++it) {
+		if((!have_right) || (right.find(*it) != right.end())) {
+			hits->insert(*it);
+		}
+	}
+	return true;
+}
+
 MatchAtomTest::~MatchAtomTest() {
 #ifndef DEBUG_MATCHTREE
 	delete m_test;
@@ -106,6 +142,19 @@ bool MatchAtomTest::match(PackageReader *p) {
 #endif
 }
 
+bool MatchAtomTest::index_lookup(DBIndex *index, DBIndex::Hits *hits) {
+#ifdef DEBUG_MATCHTREE
+	UNUSED(index);
+	UNUSED(hits);
+	return false;
+#else
+	if(m_negate || (m_pipe != NULLPTR) || (m_test == NULLPTR)) {
+		return false;
+	}
+	return m_test->index_lookup(index, hits);
+#endif
+}
+
 void MatchAtomTest::set_test(PackageTest *gtest) {
 #ifdef DEBUG_MATCHTREE
 	static int t_count(0);
@@ -138,6 +187,10 @@ bool MatchTree::match(PackageReader *p) {
 	return ((root == NULLPTR) || root->match(p));
 }
 
+bool MatchTree::index_lookup(DBIndex *index, DBIndex::Hits *hits) {
+	return ((root != NULLPTR) && root->index_lookup(index, hits));
+}
+
 void MatchTree::set_pipetest(PackageTest *gtest) {
 	MatchAtomTest *p(new MatchAtomTest);
 	p->set_test(gtest);
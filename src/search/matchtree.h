@@ -10,6 +10,7 @@
 
 #include <stack>
 
+#include "database/index.h"
 #include "eixTk/null.h"
 
 class MatchAtomOperator;
@@ -39,6 +40,10 @@ class MatchAtom {
 		 * @return true if match; else false */
 		virtual bool match(PackageReader *p) ATTRIBUTE_PURE;
 
+		/** Collect candidates for a match from the database index.
+		 * @return false if the candidates cannot be restricted this way */
+		virtual bool index_lookup(DBIndex *index, DBIndex::Hits *hits) ATTRIBUTE_NONNULL_ ATTRIBUTE_CONST;
+
 		virtual MatchAtomOperator *as_operator() {
 			return NULLPTR;
 		}
@@ -64,6 +69,8 @@ class MatchAtomOperator : public MatchAtom {
 
 		bool match(PackageReader *p);
 
+		bool index_lookup(DBIndex *index, DBIndex::Hits *hits) ATTRIBUTE_NONNULL_;
+
 		MatchAtomOperator *as_operator() {
 			return this;
 		}
@@ -83,6 +90,8 @@ class MatchAtomTest : public MatchAtom {
 
 		bool match(PackageReader *p);
 
+		bool index_lookup(DBIndex *index, DBIndex::Hits *hits) ATTRIBUTE_NONNULL_;
+
 		void set_test(PackageTest *gtest);
 
 		MatchAtomTest *as_test() {
@@ -137,6 +146,10 @@ class MatchTree {
 
 		bool match(PackageReader *p);
 
+		/** Collect the only possible matches from the database index.
+		 * @return false if all packages must be tested */
+		bool index_lookup(DBIndex *index, DBIndex::Hits *hits) ATTRIBUTE_NONNULL_;
+
 		void set_pipetest(PackageTest *gtest);
 
 		void parse_test(PackageTest *gtest, bool with_pipe);
@@ -417,6 +417,58 @@ void PackageTest::finalize() {
 	calculateNeeds();
 }
 
+bool PackageTest::index_lookup(DBIndex *index, DBIndex::Hits *hits) const {
+	if((algorithm == NULLPTR) || (field == NONE)) {
+		return false;
+	}
+	bool prefix;
+	if(!algorithm->index_lookup(&prefix) ||
+		((field & ~(NAME|CATEGORY|CATEGORY_NAME)) != NONE)) {
+		return index_scan(index, hits);
+	}
+	const string& s(algorithm->getString());
+	if(((field & NAME) != NONE) && !index->findName(hits, s, prefix)) {
+		return false;
+	}
+	if(((field & CATEGORY) != NONE) && !index->findCategory(hits, s, prefix)) {
+		return false;
+	}
+	if((field & CATEGORY_NAME) != NONE) {
+		string::size_type slash(s.find('/'));
+		if(slash == string::npos) {
+			// Without a slash, only a prefix of the category can match
+			if(prefix && !index->findCategory(hits, s, true)) {
+				return false;
+			}
+		} else if(!index->findPackage(hits, s.substr(0, slash), s.substr(slash + 1), prefix)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool PackageTest::index_scan(DBIndex *index, DBIndex::Hits *hits) const {
+	if((field & ~(NAME|CATEGORY|CATEGORY_NAME)) != NONE) {
+		return false;
+	}
+	for(DBIndex::CategoryTable::iterator c(index->categories.begin());
+		likely(c != index->categories.end()); ++c) {
+		if(unlikely(!index->load(&(*c)))) {
+			return false;
+		}
+		bool all(((field & CATEGORY) != NONE) && (*algorithm)(c->name.c_str(), NULLPTR));
+		for(DBIndex::PackageTable::const_iterator it(c->packages.begin());
+			likely(it != c->packages.end()); ++it) {
+			if(all
+			|| (((field & NAME) != NONE) && (*algorithm)(it->name.c_str(), NULLPTR))
+			|| (((field & CATEGORY_NAME) != NONE) && (*algorithm)((c->name + "/" + it->name).c_str(), NULLPTR))) {
+				hits->insert(it->offset);
+			}
+		}
+	}
+	return true;
+}
+
 /** Return true if pkg matches test. */
 bool PackageTest::stringMatch(Package *pkg) const {
 	if((((field & NAME) != NONE) && (*algorithm)(pkg->name.c_str(), pkg))
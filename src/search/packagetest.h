@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 
+#include "database/index.h"
 #include "database/package_reader.h"
 #include "eixTk/constexpr.h"
 #include "eixTk/inttypes.h"
@@ -106,6 +107,10 @@ class PackageTest {
 
 		bool match(PackageReader *pkg) const;
 
+		/** Collect the only candidates for a match from the database index.
+		 * @return false if all packages must be tested */
+		bool index_lookup(DBIndex *index, DBIndex::Hits *hits) const ATTRIBUTE_NONNULL_;
+
 		/** Set defaults (e.g. matchfield if unspecified),
 		    calculate needs. */
 		void finalize();
@@ -336,6 +341,9 @@ class PackageTest {
 
 		bool stringMatch(Package *pkg) const ATTRIBUTE_NONNULL_;
 
+		/// Test the names in the index instead of reading the packages
+		bool index_scan(DBIndex *index, DBIndex::Hits *hits) const ATTRIBUTE_NONNULL_;
+
 		void setNeeds(const PackageReader::Attributes i) {
 			if(need < i) {
 				need = i;